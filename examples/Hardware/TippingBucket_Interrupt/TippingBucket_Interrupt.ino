@@ -0,0 +1,80 @@
+/**
+ * Tipping Bucket example code showing how to timestamp each tip without waking the whole station
+ * Tips are counted in the interrupt and stamped with the RTC time in a Hypnos wake handler, the rest of the station only wakes up on the RTC alarm
+ * Rainfall over the last 5 minutes, hour and 24 hours as well as the max intensity are added to each package
+ *
+ * MANAGER MUST BE INCLUDED FIRST IN ALL CODE
+ */
+
+#include <Loom_Manager.h>
+
+#include <Hardware/Loom_TippingBucket/Loom_TippingBucket.h>
+#include <Hardware/Loom_Hypnos/Loom_Hypnos.h>
+
+// Pin the tipping bucket is connected to
+#define INT_PIN A0
+
+Manager manager("Device", 1);
+
+Loom_Hypnos hypnos(manager, HYPNOS_VERSION::V3_3, TIME_ZONE::PST);
+
+// Manager Instance, Counter type, Inches of rainfall per tip
+Loom_TippingBucket bucket(manager, COUNTER_TYPE::INTERRUPT, 0.01f);
+
+// Called when the RTC alarm is triggered
+void isrTrigger(){
+  hypnos.wakeup();
+}
+
+// Called when the bucket tips, only counts the tip
+void tipTrigger(){
+  bucket.tipDetected();
+}
+
+// Called after a tip wakes the device, stamps the tip and goes back to sleep
+bool onTip(){
+  bucket.recordTips();
+  return false;
+}
+
+void setup() {
+
+  // Start the serial interface
+  manager.beginSerial();
+
+  // Enable the hypnos rails
+  hypnos.enable();
+
+  // Tips are stamped with the RTC time
+  bucket.setHypnosInstance(hypnos);
+
+  // Initialize the manager
+  manager.initialize();
+
+  // Register the RTC alarm and the tipping bucket
+  hypnos.registerInterrupt(isrTrigger);
+  hypnos.registerInterrupt(tipTrigger, INT_PIN, HypnosInterruptType::OTHER, FALLING);
+  hypnos.registerWakeHandler(INT_PIN, onTip);
+}
+
+void loop() {
+
+  // Measure and package the data
+  manager.measure();
+  manager.package();
+
+  // Print the collected output to the Serial monitor
+  manager.display_data();
+
+  // Log the data to the SD card
+  hypnos.logToSD();
+
+  // Set the RTC interrupt alarm to wake the device in 15 minutes
+  hypnos.setInterruptDuration(TimeSpan(0, 0, 15, 0));
+
+  // Reattach to the interrupt after we have set the alarm so we can have repeat triggers
+  hypnos.reattachRTCInterrupt();
+
+  // Put the device into a deep sleep, tips are recorded without returning here
+  hypnos.sleep();
+}
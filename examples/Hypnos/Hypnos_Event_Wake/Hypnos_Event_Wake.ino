@@ -0,0 +1,79 @@
+/**
+ * This is an example of handling an event interrupt (eg. a tipping bucket) without fully waking the Hypnos
+ * The tip is counted with the power rails still off and the device goes straight back to sleep, the sensors are only powered up when the RTC alarm fires
+ * 
+ * MANAGER MUST BE INCLUDED FIRST IN ALL CODE
+ */
+
+#include <Loom_Manager.h>
+
+#include <Hardware/Loom_Hypnos/Loom_Hypnos.h>
+
+// Pin the tipping bucket is connected to
+#define TIP_PIN A0
+
+Manager manager("Device", 1);
+
+// Create a new Hypnos object
+Loom_Hypnos hypnos(manager, HYPNOS_VERSION::V3_3, TIME_ZONE::PST);
+
+volatile uint32_t tipCount = 0;
+
+// Called when the RTC alarm is triggered 
+void isrTrigger(){
+  hypnos.wakeup();
+}
+
+// Called when the bucket tips, nothing needs to happen in the interrupt itself
+void tipTrigger(){}
+
+// Called after the bucket woke the device, before anything is powered up
+bool onTip(){
+  tipCount++;
+
+  // Go straight back to sleep
+  return false;
+}
+
+void setup() {
+
+  // Start the serial interface
+  manager.beginSerial();
+
+  // Enable the hypnos rails
+  hypnos.enable();
+
+  // Initialize all in-use modules
+  manager.initialize();
+
+  // Register the RTC alarm and the tipping bucket, only the bucket gets a wake handler so the alarm always fully wakes the device
+  hypnos.registerInterrupt(isrTrigger);
+  hypnos.registerInterrupt(tipTrigger, TIP_PIN, HypnosInterruptType::OTHER, FALLING);
+  hypnos.registerWakeHandler(TIP_PIN, onTip);
+}
+
+void loop() {
+
+  // Measure and package the data
+  manager.measure();
+  manager.package();
+
+  // Add the number of tips counted while asleep
+  manager.addData("Bucket", "Tips", tipCount);
+  tipCount = 0;
+
+  // Print the current JSON packet
+  manager.display_data();
+
+  // Log the data to the SD card
+  hypnos.logToSD();
+
+  // Set the RTC interrupt alarm to wake the device in 15 minutes
+  hypnos.setInterruptDuration(TimeSpan(0, 0, 15, 0));
+
+  // Reattach to the interrupt after we have set the alarm so we can have repeat triggers
+  hypnos.reattachRTCInterrupt();
+  
+  // Put the device into a deep sleep, tips are counted without returning here until the alarm goes off
+  hypnos.sleep();
+}
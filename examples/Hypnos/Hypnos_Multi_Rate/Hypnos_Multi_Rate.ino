@@ -0,0 +1,68 @@
+/**
+ * This is an example use case for sampling modules at different rates with the Hypnos
+ * The analog pins are sampled every minute while the SHT31 is only sampled every 10 minutes, 
+ * the Hypnos sets its alarm for whichever module is due next.
+ * 
+ * NOTE: THIS EXAMPLE DOESN"T WAIT FOR SERIAL AFTER SLEEPING
+ * MANAGER MUST BE INCLUDED FIRST IN ALL CODE
+ */
+
+#include <Loom_Manager.h>
+
+#include <Hardware/Loom_Hypnos/Loom_Hypnos.h>
+#include <Sensors/Loom_Analog/Loom_Analog.h>
+#include <Sensors/I2C/Loom_SHT31/Loom_SHT31.h>
+
+Manager manager("Device", 1);
+
+// Create a new Hypnos object setting the version to determine the SD Chip select pin
+Loom_Hypnos hypnos(manager, HYPNOS_VERSION::V3_3, TIME_ZONE::PST);
+
+Loom_Analog analog(manager, A0);
+Loom_SHT31 sht(manager);
+
+// Called when the interrupt is triggered 
+void isrTrigger(){
+  hypnos.wakeup();
+}
+
+void setup() {
+
+  // Start the serial interface
+  manager.beginSerial();
+
+  // Sample the analog pins every minute and the SHT31 every 10 minutes, 30 seconds into the period so it doesn't line up with the analog sample
+  analog.setSchedule(60);
+  sht.setSchedule(600, 30);
+
+  // Enable the hypnos rails
+  hypnos.enable();
+
+  // Called after enable
+  manager.initialize();
+
+  // Register the ISR and attach to the interrupt
+  hypnos.registerInterrupt(isrTrigger);
+}
+
+void loop() {
+
+  // Measure and package only the modules that are due
+  manager.measure();
+  manager.package();
+  
+  // Print the current JSON packet
+  manager.display_data();            
+
+  // Log the data to the SD card, modules that weren't due are left blank
+  hypnos.logToSD();
+
+  // Set the alarm for the next module that is due, this must be called after measure() as that is when the deadlines are updated
+  hypnos.setScheduledInterrupt(TimeSpan(0, 1, 0, 0));
+
+  // Reattach to the interrupt after we have set the alarm so we can have repeat triggers
+  hypnos.reattachRTCInterrupt();
+  
+  // Put the device into a deep sleep, operation HALTS here until the interrupt is triggered
+  hypnos.sleep();
+}
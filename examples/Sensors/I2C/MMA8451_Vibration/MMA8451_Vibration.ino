@@ -0,0 +1,43 @@
+/**
+ * MMA8451 vibration monitoring example code
+ * Each measure drains a burst of samples from the sensor's FIFO at 800Hz and only the RMS, peak, crest factor and energy in each frequency band are packaged
+ * 
+ * MANAGER MUST BE INCLUDED FIRST IN ALL CODE
+ */
+
+
+#include <Loom_Manager.h>
+
+#include <Sensors/I2C/Loom_MMA8451/Loom_MMA8451.h>
+
+Manager manager("Device", 1);
+
+// Manger Instance, Address, Use Mux, Range
+Loom_MMA8451 mma(manager, 0x1D, false, MMA8451_RANGE_2_G);
+
+void setup() {
+
+  // Start the serial interface
+  manager.beginSerial();
+
+  // Compute the features on the length of the acceleration vector so it doesn't matter how the sensor is mounted
+  mma.setBurstMode(true, VIBRATION_AXIS::MAGNITUDE);
+
+  // Initialize the manager
+  manager.initialize();
+}
+
+void loop() {
+
+  // Capture a burst and compute the features
+  manager.measure();
+
+  // Package the features into JSON
+  manager.package();
+
+  // Print the JSON document to the Serial monitor
+  manager.display_data();
+
+  // Wait for 5 seconds
+  manager.pause(5000);
+}
@@ -11,9 +11,13 @@
 
 Manager manager("Device", 1);
 
-// Reads the battery voltage
+// Loads any supported sensor plugged into the multiplexer
 Loom_Multiplexer mux(manager);
 
+// To keep the flash size down only list the sensors that will be used, only their drivers get linked in
+// const MuxSensorType sensorTypes[] = {MUX_SHT31, MUX_TSL2591};
+// Loom_Multiplexer mux(manager, sensorTypes);
+
 void setup() {
 
   // Start the serial interface
@@ -1,8 +1,9 @@
 #include "Loom_BatchSD.h"
 #include "Logger.h"
+#include "../../Sensors/Loom_Analog/Loom_Analog.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Loom_BatchSD::Loom_BatchSD(Loom_Hypnos& hypnos, int batchSize) : batchSize(batchSize){
+Loom_BatchSD::Loom_BatchSD(Loom_Hypnos& hypnos, int batchSize) : hypnosInst(&hypnos), batchSize(batchSize){
     sdMan = hypnos.getSDManager();
     sdMan->setBatchSize(batchSize);
 }
@@ -10,12 +11,81 @@ Loom_BatchSD::Loom_BatchSD(Loom_Hypnos& hypnos, int batchSize) : batchSize(batch
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 bool Loom_BatchSD::shouldPublish(){
-    return (sdMan->getCurrentBatch() == batchSize);
+    if(policy == nullptr)
+        return (sdMan->getCurrentBatch() == batchSize);
+
+    int backlog = sdMan->getCurrentBatch();
+
+    // Stick with the decision made when the uplink was powered up so we don't publish without a connection
+    if(plannedBacklog == backlog){
+        plannedBacklog = -1;
+        return uploadPlanned;
+    }
+
+    return policy->shouldUpload(getConditions(backlog));
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_BatchSD::shouldPowerUp(){
+    if(policy == nullptr)
+        return (sdMan->getCurrentBatch() == batchSize - 1);
+
+    // The uplink is powered up before this cycle's packet is logged
+    plannedBacklog = sdMan->getCurrentBatch() + 1;
+    uploadPlanned = policy->shouldUpload(getConditions(plannedBacklog));
+    return uploadPlanned;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_BatchSD::setUploadPolicy(UploadPolicy& policy, int maxBacklog){
+    this->policy = &policy;
+    this->maxBacklog = max(maxBacklog, batchSize);
+    sdMan->setBatchLimit(this->maxBacklog);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_BatchSD::recordSignalStrength(int dBm){
+    signalStrength = dBm;
+    signalTime = hypnosInst->getCurrentTime().unixtime();
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+UploadConditions Loom_BatchSD::getConditions(int backlog){
+    UploadConditions conditions;
+    DateTime now = hypnosInst->getCurrentTime();
+    float voltage = Loom_Analog::getBatteryVoltage();
+
+    // Smooth the rate of change over readings far enough apart that ADC noise doesn't dominate
+    if(lastVoltageTime == 0){
+        lastVoltage = voltage;
+        lastVoltageTime = now.unixtime();
+    }
+    else if(now.unixtime() - lastVoltageTime >= BATTERY_TREND_INTERVAL){
+        float rate = (voltage - lastVoltage) * 3600.0 / (now.unixtime() - lastVoltageTime);
+        batteryTrend = BATTERY_TREND_WEIGHT * rate + (1 - BATTERY_TREND_WEIGHT) * batteryTrend;
+        lastVoltage = voltage;
+        lastVoltageTime = now.unixtime();
+    }
+
+    conditions.batteryVoltage = voltage;
+    conditions.batteryTrend = batteryTrend;
+    conditions.signalStrength = (signalTime > 0 && now.unixtime() - signalTime < SIGNAL_MAX_AGE) ? signalStrength : SIGNAL_UNKNOWN;
+    conditions.backlog = backlog;
+    conditions.batchSize = batchSize;
+    conditions.maxBacklog = maxBacklog;
+    conditions.hour = now.hour();
+    return conditions;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 File& Loom_BatchSD::getBatch(){
+    // The trim rewrites the file so it can't be left to run while the batch is being read
+    sdMan->finishBatchTrim();
     return sdMan->getFile(sdMan->getBatchFilename());
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
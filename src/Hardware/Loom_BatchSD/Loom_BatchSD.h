@@ -2,6 +2,11 @@
 
 #include <vector>
 #include "../Loom_Hypnos/Loom_Hypnos.h"
+#include "Loom_UploadPolicy.h"
+
+#define SIGNAL_MAX_AGE 86400                // Seconds before a reported signal strength is considered stale
+#define BATTERY_TREND_INTERVAL 600          // Minimum seconds between battery readings used for the trend
+#define BATTERY_TREND_WEIGHT 0.3            // Weight of the newest reading in the smoothed battery trend
 
 /**
  * Basic wrapper for SD to manage batch uploading
@@ -21,6 +26,33 @@ class Loom_BatchSD{
          */ 
         bool shouldPublish();
 
+        /**
+         * Returns if the uplink should be powered up this cycle so it is ready when the batch is published after logging
+         */
+        bool shouldPowerUp();
+
+        /**
+         * Let a policy decide when to upload instead of always uploading every batchSize packets
+         * While the policy defers, the batch file keeps growing up to maxBacklog packets, after that the oldest batchSize packets are dropped to make room for each new batch
+         * @param policy Policy to use
+         * @param maxBacklog Most packets to keep while uploads are being deferred
+         */
+        void setUploadPolicy(UploadPolicy& policy, int maxBacklog);
+
+        /* Whether or not an upload policy is in use */
+        bool hasUploadPolicy() { return policy != nullptr; };
+
+        /**
+         * Called by the uplink with its latest signal strength so the policy can use it
+         * @param dBm Signal strength in dBm
+         */
+        void recordSignalStrength(int dBm);
+
+        /**
+         * Called once the batch has been sent successfully so the next packet starts a new batch
+         */
+        void markPublished() { sdMan->markBatchPublished(); };
+
         /**
          * Return a pointer to the open memory read from arduino
          */ 
@@ -38,5 +70,21 @@ class Loom_BatchSD{
 
     private:
         SDManager* sdMan = nullptr;                 // Pointer to the SD manager
+        Loom_Hypnos* hypnosInst = nullptr;          // Used for the time of day
         int batchSize;                              // Batch size to log to
+
+        /* Upload policy */
+        UploadPolicy* policy = nullptr;             // Decides when to upload, nullptr to upload every batchSize packets
+        int maxBacklog = 0;                         // Most packets kept while uploads are deferred
+        bool uploadPlanned = false;                 // Decision made when the uplink was powered up
+        int plannedBacklog = -1;                    // Backlog the planned decision was made for, -1 if there isn't one
+
+        int signalStrength = SIGNAL_UNKNOWN;        // Last reported signal strength in dBm
+        uint32_t signalTime = 0;                    // When the signal strength was reported
+
+        float lastVoltage = 0;                      // Battery voltage at the last trend update
+        uint32_t lastVoltageTime = 0;               // When the last trend update happened
+        float batteryTrend = 0;                     // Smoothed change in battery voltage in volts per hour
+
+        UploadConditions getConditions(int backlog);    // Gather everything the policy needs
 };
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "Loom_UploadPolicy.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_UploadPolicy::shouldUpload(const UploadConditions& conditions){
+
+    // Not worth bringing the radio up for a partial batch, and never worth a brown out
+    if(conditions.backlog < conditions.batchSize || conditions.batteryVoltage < minVoltage)
+        return false;
+
+    // Send whatever we have before the batch file fills up and starts over
+    if(conditions.maxBacklog > 0 && conditions.backlog >= conditions.maxBacklog)
+        return true;
+
+    // Otherwise wait for good conditions, the batch keeps growing until then
+    if(conditions.batteryTrend < -maxDischargeRate)
+        return false;
+
+    if(conditions.signalStrength != SIGNAL_UNKNOWN && conditions.signalStrength < minSignal)
+        return false;
+
+    return inPreferredHours(conditions.hour);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_UploadPolicy::inPreferredHours(int hour){
+    if(startHour <= endHour)
+        return hour >= startHour && hour < endHour;
+
+    // The window wraps past midnight
+    return hour >= startHour || hour < endHour;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
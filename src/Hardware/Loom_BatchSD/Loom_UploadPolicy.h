@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Arduino.h"
+
+#define SIGNAL_UNKNOWN 0                    // Signal strength used when the uplink hasn't reported one recently
+
+/**
+ * Everything an upload policy gets to base its decision on
+ */
+struct UploadConditions{
+    float batteryVoltage;                   // Current battery voltage
+    float batteryTrend;                     // Change in battery voltage in volts per hour, negative while discharging
+    int signalStrength;                     // Last signal strength reported by the uplink in dBm, SIGNAL_UNKNOWN if there isn't a recent one
+    int backlog;                            // Packets waiting in the batch file
+    int batchSize;                          // Packets that normally make up one upload
+    int maxBacklog;                         // Packets the batch file holds before it is cleared and the data is lost
+    int hour;                               // Current hour of the day (UTC)
+};
+
+/**
+ * Decides whether the uplink should be brought up to send the batch
+ * Implement this to plug a different decision into Loom_BatchSD
+ */
+class UploadPolicy{
+    public:
+        virtual ~UploadPolicy() {};
+
+        /**
+         * Whether the batch should be uploaded given the current conditions
+         * @param conditions Battery, signal, backlog and time of day
+         */
+        virtual bool shouldUpload(const UploadConditions& conditions) = 0;
+};
+
+/**
+ * Default upload policy
+ * Uploads once a full batch is waiting if the battery is healthy, the signal is good and it is within the preferred hours, otherwise the upload is deferred and the batch keeps growing
+ * Once the backlog is about to be lost the upload happens anyway as long as the battery is above the minimum
+ */
+class Loom_UploadPolicy : public UploadPolicy{
+    public:
+        bool shouldUpload(const UploadConditions& conditions) override;
+
+        /**
+         * Battery thresholds
+         * @param minVoltage Never upload below this voltage
+         * @param maxDischargeRate Defer while the battery is dropping faster than this many volts per hour
+         */
+        void setBatteryLimits(float minVoltage, float maxDischargeRate) { this->minVoltage = minVoltage; this->maxDischargeRate = maxDischargeRate; };
+
+        /**
+         * Defer while the last reported signal is weaker than this
+         * @param minSignal Signal strength in dBm
+         */
+        void setMinSignal(int minSignal) { this->minSignal = minSignal; };
+
+        /**
+         * Only upload between these hours unless the backlog is full, start can be after end to wrap past midnight
+         * @param startHour First hour uploads are allowed (UTC)
+         * @param endHour Hour uploads stop being allowed (UTC)
+         */
+        void setPreferredHours(uint8_t startHour, uint8_t endHour) { this->startHour = startHour; this->endHour = endHour; };
+
+    private:
+        float minVoltage = 3.4;             // Never upload below this voltage
+        float maxDischargeRate = 0.05;      // Volts per hour
+        int minSignal = -105;               // dBm
+        uint8_t startHour = 0;              // First hour uploads are allowed
+        uint8_t endHour = 24;               // Hour uploads stop being allowed
+
+        bool inPreferredHours(int hour);
+};
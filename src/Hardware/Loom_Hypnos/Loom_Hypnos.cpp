@@ -1,6 +1,24 @@
 #include "Loom_Hypnos.h"
 #include "Logger.h"
 
+#include <Wire.h>
+
+#define DS3231_ADDRESS 0x68         // I2C address of the RTC
+#define DS3231_AGING_REG 0x10       // Aging offset register
+#define DS3231_CONTROL_REG 0x0E     // Control register, setting CONV forces a temperature conversion which applies a new aging offset
+#define SLEEP_CLOCK_GCLK 2          // Generic clock that feeds the 32kHz crystal to the SAMD's RTC while asleep
+
+Loom_Hypnos::WakeSource Loom_Hypnos::wakeSources[MAX_WAKE_SOURCES];
+volatile uint32_t Loom_Hypnos::wakeReasons = 0;
+
+// One wrapper per slot so each interrupt can record itself without knowing its pin
+const InterruptCallbackFunction Loom_Hypnos::wakeISRs[MAX_WAKE_SOURCES] = {
+    Loom_Hypnos::wakeISR<0>,
+    Loom_Hypnos::wakeISR<1>,
+    Loom_Hypnos::wakeISR<2>,
+    Loom_Hypnos::wakeISR<3>
+};
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 Loom_Hypnos::Loom_Hypnos(Manager& man, HYPNOS_VERSION version, TIME_ZONE zone, bool use_custom_time, bool useSD) : Module("Hypnos"), custom_time(use_custom_time), sd_chip_select(version), enableSD(useSD), timezone(zone){
     manInst = &man;
@@ -38,6 +56,10 @@ void Loom_Hypnos::package(){
     char timeStr[21];
     char localStr[21];
 
+    // Use the connection if it happens to be up rather than waking the radio just for the time
+    if(autoTimeSync && networkComponent != nullptr && isTimeSyncDue() && networkComponent->isConnected())
+        networkTimeUpdate();
+
     time = getCurrentTime();
     localTime = getLocalTime(time);
 
@@ -46,6 +68,9 @@ void Loom_Hypnos::package(){
 
     dateTime_toString(localTime, localStr, true);
     json["time_local"] = localStr;
+
+    if(fastWake)
+        manInst->addData(getModuleName(), "Wake_Latency", manInst->getWakeLatency());
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -65,13 +90,25 @@ void Loom_Hypnos::enable(bool enable33, bool enable5){
         pinMode(24, OUTPUT);
         pinMode(sd_chip_select, OUTPUT);
 
-        sdMan->begin();
+        // The card keeps its state as long as the 3.3v rail stays on, so with fast wake it only needs restarting if the rail was turned off
+        if(!fastWake || powerLost3V)
+            sdMan->begin();
     }
 
+    // Everything on an enabled rail is now powered and initialized
+    if(enable33)
+        powerLost3V = false;
+    if(enable5)
+        powerLost5V = false;
+
     // If the RTC hasn't already been initialized then do so now
     if(!RTC_initialized)
         initializeRTC();
 
+    // Keep the scheduler in sync with the RTC as millis() doesn't advance while asleep
+    if(RTC_initialized)
+        manInst->setScheduleTime(RTC_DS.now().unixtime());
+
     manInst->setEnableState(true);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -90,6 +127,11 @@ void Loom_Hypnos::disable(bool disable33, bool disable5){
         pinMode(sd_chip_select, INPUT);
     }
 
+    if(disable33)
+        powerLost3V = true;
+    if(disable5)
+        powerLost5V = true;
+
     manInst->setEnableState(false);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -184,18 +226,36 @@ bool Loom_Hypnos::registerInterrupt(InterruptCallbackFunction isrFunc, int inter
     // Make sure a callback function was supplied
     if(isrFunc != nullptr){
 
+        // Find the slot the pin already has or the first free one
+        int slot = getWakeSlot(interruptPin);
+        for(int i = 0; i < MAX_WAKE_SOURCES && slot < 0; i++){
+            if(wakeSources[i].pin < 0)
+                slot = i;
+        }
+
+        if(slot < 0){
+            ERROR(F("Failed to attach interrupt! The maximum number of interrupts are already registered"));
+            FUNCTION_END;
+            return false;
+        }
+
+        // The slot's wrapper is what is actually attached so we know which interrupt woke the device
+        wakeSources[slot].pin = interruptPin;
+        wakeSources[slot].isr = isrFunc;
+        InterruptCallbackFunction isr = wakeISRs[slot];
+
          // If the interrupt we registered is for sleep we should set the interrupt to wake the device from sleep
         if(interruptType == SLEEP){
-            LowPower.attachInterruptWakeup(interruptPin, isrFunc, triggerState);
+            LowPower.attachInterruptWakeup(interruptPin, isr, triggerState);
             LOG(F("Interrupt successfully attached!"));
         }
         else{
-            attachInterrupt(digitalPinToInterrupt(interruptPin), isrFunc, triggerState);
-            attachInterrupt(digitalPinToInterrupt(interruptPin), isrFunc, triggerState);
+            attachInterrupt(digitalPinToInterrupt(interruptPin), isr, triggerState);
+            attachInterrupt(digitalPinToInterrupt(interruptPin), isr, triggerState);
             LOG(F("Interrupt successfully attached!"));
         }
         // Add the interrupt to the list of pin to interrupts
-        pinToInterrupt.insert(std::make_pair(interruptPin, std::make_tuple(isrFunc, triggerState, interruptType)));
+        pinToInterrupt[interruptPin] = std::make_tuple(isr, triggerState, interruptType);
         FUNCTION_END;
         return true;
     }
@@ -210,18 +270,95 @@ bool Loom_Hypnos::registerInterrupt(InterruptCallbackFunction isrFunc, int inter
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_Hypnos::registerWakeHandler(int interruptPin, WakeHandlerFunction handler){
+    int slot = getWakeSlot(interruptPin);
+    if(slot < 0){
+        ERROR(F("Failed to register wake handler! Interrupt has not previously been registered..."));
+        return false;
+    }
+
+    wakeSources[slot].handler = handler;
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_Hypnos::wokeFrom(int interruptPin){
+    int slot = getWakeSlot(interruptPin);
+    return slot >= 0 && (lastWakeReasons & (1UL << slot));
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+int Loom_Hypnos::getWakeSlot(int interruptPin){
+    for(int i = 0; i < MAX_WAKE_SOURCES; i++){
+        if(wakeSources[i].pin == interruptPin)
+            return i;
+    }
+    return -1;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_Hypnos::handleWakeEvents(){
+
+    // Take the reasons with interrupts off so one firing now isn't lost
+    noInterrupts();
+    uint32_t reasons = wakeReasons;
+    wakeReasons = 0;
+    interrupts();
+
+    // Woken by something that wasn't registered, always fully wake
+    if(reasons == 0)
+        return false;
+
+    while(reasons != 0){
+        lastWakeReasons |= reasons;
+
+        // Every source that fired gets its handler run before deciding, a tip that arrives with the RTC alarm still has to be counted
+        bool fullWake = false;
+        for(int i = 0; i < MAX_WAKE_SOURCES; i++){
+            if(!(reasons & (1UL << i)))
+                continue;
+
+            // Sources without a handler (eg. the RTC alarm) always need the full wake
+            if(wakeSources[i].handler == nullptr || wakeSources[i].handler()){
+                fullWake = true;
+                continue;
+            }
+
+            // The ISR may have detached itself, make sure it can wake us again, nothing is logged as the SD card and Serial are off
+            auto& interrupt = pinToInterrupt[wakeSources[i].pin];
+            attachInterrupt(digitalPinToInterrupt(wakeSources[i].pin), std::get<0>(interrupt), std::get<1>(interrupt));
+        }
+
+        if(fullWake)
+            return false;
+
+        // Handle anything that fired while the handlers were running before going back to sleep
+        noInterrupts();
+        reasons = wakeReasons;
+        wakeReasons = 0;
+        interrupts();
+    }
+
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 bool Loom_Hypnos::reattachRTCInterrupt(int interruptPin){
     FUNCTION_START;
-    if(std::get<2>(pinToInterrupt[interruptPin]) != SLEEP){
 
-        // If we haven't previously registered the interrupt we need to do this before we can reattach to an interrupt that doesn't exist
-        if(pinToInterrupt.count(interruptPin) <= 0){
-            ERROR(F("Failed to reattach interrupt! Interrupt has not previously been registered..."));
-            FUNCTION_END;
-            return false;
-        }
+    // If we haven't previously registered the interrupt we need to do this before we can reattach to an interrupt that doesn't exist
+    if(pinToInterrupt.count(interruptPin) <= 0){
+        ERROR(F("Failed to reattach interrupt! Interrupt has not previously been registered..."));
+        FUNCTION_END;
+        return false;
+    }
 
+    if(std::get<2>(pinToInterrupt[interruptPin]) != SLEEP){
         attachInterrupt(digitalPinToInterrupt(interruptPin), std::get<0>(pinToInterrupt[interruptPin]), std::get<1>(pinToInterrupt[interruptPin]));
         attachInterrupt(digitalPinToInterrupt(interruptPin), std::get<0>(pinToInterrupt[interruptPin]), std::get<1>(pinToInterrupt[interruptPin]));
     }
@@ -266,6 +403,9 @@ void Loom_Hypnos::initializeRTC(){
 	// Clear any pending alarms
 	RTC_DS.clearAlarm();
 
+    // The aging offset is kept by the RTC's backup battery so pick up any trim from before a reset
+    readAgingOffset();
+
     RTC_DS.writeSqwPinMode(DS3231_OFF);
 
     // We successfully started the RTC
@@ -305,10 +445,57 @@ bool Loom_Hypnos::isDaylightSavings(){
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t Loom_Hypnos::getUnixTime(){
+    if(asleep)
+        return sleepStartTime + readSleepClock();
+    return getCurrentTime().unixtime();
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Hypnos::startSleepClock(){
+    // Keep the crystal running in standby and divide it down to 1024Hz for the RTC, 32768 / 2^(4 + 1)
+    SYSCTRL->XOSC32K.reg |= SYSCTRL_XOSC32K_RUNSTDBY;
+    GCLK->GENDIV.reg = GCLK_GENDIV_ID(SLEEP_CLOCK_GCLK) | GCLK_GENDIV_DIV(4);
+    while(GCLK->STATUS.bit.SYNCBUSY);
+    GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(SLEEP_CLOCK_GCLK) | GCLK_GENCTRL_SRC_XOSC32K | GCLK_GENCTRL_GENEN | GCLK_GENCTRL_DIVSEL | GCLK_GENCTRL_RUNSTDBY;
+    while(GCLK->STATUS.bit.SYNCBUSY);
+    GCLK->CLKCTRL.reg = (uint16_t)(GCLK_CLKCTRL_ID(RTC_GCLK_ID) | GCLK_CLKCTRL_GEN(SLEEP_CLOCK_GCLK) | GCLK_CLKCTRL_CLKEN);
+    while(GCLK->STATUS.bit.SYNCBUSY);
+    PM->APBAMASK.reg |= PM_APBAMASK_RTC;
+
+    // 32-bit counter that ticks once a second, restarted from 0 every time the device goes to sleep
+    RTC->MODE0.CTRL.reg &= ~RTC_MODE0_CTRL_ENABLE;
+    while(RTC->MODE0.STATUS.bit.SYNCBUSY);
+    RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_MODE_COUNT32 | RTC_MODE0_CTRL_PRESCALER_DIV1024;
+    while(RTC->MODE0.STATUS.bit.SYNCBUSY);
+    RTC->MODE0.COUNT.reg = 0;
+    while(RTC->MODE0.STATUS.bit.SYNCBUSY);
+    RTC->MODE0.CTRL.reg |= RTC_MODE0_CTRL_ENABLE;
+    while(RTC->MODE0.STATUS.bit.SYNCBUSY);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t Loom_Hypnos::readSleepClock(){
+    // The count is in the RTC's clock domain so it has to be synchronized before it is read
+    RTC->MODE0.READREQ.reg = RTC_READREQ_RREQ;
+    while(RTC->MODE0.STATUS.bit.SYNCBUSY);
+    return RTC->MODE0.COUNT.reg;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 DateTime Loom_Hypnos::getCurrentTime(){
-    if(RTC_initialized)
-        return RTC_DS.now();
+    if(RTC_initialized){
+        DateTime now = RTC_DS.now();
+
+        // Take out the drift that has built up since the last sync
+        if(driftKnown && now.unixtime() > lastSyncTime)
+            return now - TimeSpan(lround(driftPPM * (now.unixtime() - lastSyncTime) / 1e6));
+        return now;
+    }
     else{
         LOG(F("Attempted to pull time when RTC was not previously initialized! Returned default datetime"));
         return DateTime();
@@ -319,6 +506,7 @@ DateTime Loom_Hypnos::getCurrentTime(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 bool Loom_Hypnos::networkTimeUpdate(){
     FUNCTION_START;
+    bool success = false;
     if(networkComponent != nullptr && networkComponent->isConnected()){
         char output[OUTPUT_SIZE];
         int year, month, day, hour, minute, second = 0;
@@ -330,9 +518,10 @@ bool Loom_Hypnos::networkTimeUpdate(){
 
             // Attempt to retrieve the current time from our network component
             if(networkComponent->getNetworkTime(&year, &month, &day, &hour, &minute, &second, &tz)){
-                RTC_DS.adjust(DateTime(year, month, day, hour, minute, second));
+                updateDrift(DateTime(year, month, day, hour, minute, second));
                 snprintf(output, OUTPUT_SIZE, "Network time successfully set to: %s", getCurrentTime().text());
                 LOG(output);
+                success = true;
                 break;
             }else{
                 ERROR("Failed to get network time! Time has not been set. Retrying...");
@@ -342,6 +531,108 @@ bool Loom_Hypnos::networkTimeUpdate(){
         ERROR("Network component not set in hypnos or component wasn't connected to the internet.");
     }
     FUNCTION_END;
+    return success;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Hypnos::updateDrift(DateTime networkTime){
+    uint32_t now = networkTime.unixtime();
+    int32_t offset = (int32_t)(RTC_DS.now().unixtime() - now);         // Positive when the RTC is fast
+    bool restart = false;
+
+    // First sync or the clock was set some other way since, start measuring from here
+    if(driftRefTime == 0 || now <= driftRefTime || abs(offset) > MAX_DRIFT_OFFSET){
+        restart = true;
+    }
+    else{
+        uint32_t elapsed = now - driftRefTime;
+
+        // The drift is measured over the whole time since the reference so the one second resolution of the network time matters less the longer it runs
+        if(elapsed >= MIN_DRIFT_INTERVAL){
+            driftPPM = (driftCorrection + offset) * 1e6 / elapsed;
+            driftKnown = true;
+            LOGF("Measured RTC drift: %.2f ppm", driftPPM);
+
+            // Once the estimate is solid trim the oscillator so the RTC keeps better time between syncs, a higher offset slows it down
+            if(elapsed >= AGING_INTERVAL && fabs(driftPPM) >= AGING_PPM_PER_STEP){
+                int8_t newOffset = constrain(agingOffset + lround(driftPPM / AGING_PPM_PER_STEP), -127, 127);
+                int8_t step = newOffset - agingOffset;
+                if(step != 0 && writeAgingOffset(newOffset)){
+                    LOGF("RTC aging offset set to %i", newOffset);
+                    driftPPM -= step * AGING_PPM_PER_STEP;
+                    restart = true;
+                }
+            }
+        }
+    }
+
+    // Only step the clock when it is actually off so the measurement isn't reset for nothing
+    if(offset != 0){
+        RTC_DS.adjust(networkTime);
+        driftCorrection += offset;
+    }
+
+    if(restart){
+        driftRefTime = now;
+        driftCorrection = 0;
+    }
+    lastSyncTime = now;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+float Loom_Hypnos::getExpectedTimeError(){
+    if(lastSyncTime == 0 || !RTC_initialized)
+        return 0;
+
+    uint32_t now = RTC_DS.now().unixtime();
+    uint32_t sinceSync = (now > lastSyncTime) ? now - lastSyncTime : 0;
+
+    // The measured drift is only as good as the one second resolution over the time it was measured
+    float ppm = DEFAULT_DRIFT_PPM;
+    if(driftKnown && lastSyncTime > driftRefTime)
+        ppm = fabs(driftPPM) + 1e6 / (lastSyncTime - driftRefTime);
+    else if(driftKnown)
+        ppm = fabs(driftPPM) + DEFAULT_DRIFT_PPM;
+
+    // Half a second for the network time only being to the second
+    return 0.5 + ppm * sinceSync / 1e6;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_Hypnos::readAgingOffset(){
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(DS3231_AGING_REG);
+    if(Wire.endTransmission() != 0 || Wire.requestFrom(DS3231_ADDRESS, 1) != 1)
+        return false;
+
+    agingOffset = (int8_t)Wire.read();
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_Hypnos::writeAgingOffset(int8_t offset){
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(DS3231_AGING_REG);
+    Wire.write((uint8_t)offset);
+    if(Wire.endTransmission() != 0)
+        return false;
+    agingOffset = offset;
+
+    // The new offset normally only takes effect at the next temperature conversion, force one now
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(DS3231_CONTROL_REG);
+    if(Wire.endTransmission() == 0 && Wire.requestFrom(DS3231_ADDRESS, 1) == 1){
+        uint8_t control = Wire.read();
+        Wire.beginTransmission(DS3231_ADDRESS);
+        Wire.write(DS3231_CONTROL_REG);
+        Wire.write(control | 0x20);
+        Wire.endTransmission();
+    }
+    return true;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -444,8 +735,11 @@ void Loom_Hypnos::setInterruptDuration(const TimeSpan duration){
     FUNCTION_START;
     char output[OUTPUT_SIZE];
 
-    // The time in the future that the alarm will be set for
-    alarmTime = RTC_DS.now() + duration;
+    // The time in the future that the alarm will be set for, stretched or shrunk by the drift so it goes off after the real duration
+    int32_t seconds = duration.totalseconds();
+    if(driftKnown)
+        seconds += lround(seconds * driftPPM / 1e6);
+    alarmTime = RTC_DS.now() + TimeSpan(seconds);
     RTC_DS.setAlarm(alarmTime);
 
     // Print the time that the next interrupt is set to trigger
@@ -455,6 +749,21 @@ void Loom_Hypnos::setInterruptDuration(const TimeSpan duration){
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Hypnos::setScheduledInterrupt(const TimeSpan maxDuration){
+    uint32_t now = RTC_DS.now().unixtime();
+    uint32_t duration = maxDuration.totalseconds();
+    uint32_t nextSample = manInst->getNextScheduledSample();
+
+    // Wake for whichever scheduled module is due first, the alarm can't be set for the current second
+    if(nextSample != 0){
+        duration = min(duration, (nextSample > now) ? nextSample - now : (uint32_t)1);
+    }
+
+    setInterruptDuration(TimeSpan(duration));
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /* Sleep Functionality */
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -479,9 +788,22 @@ void Loom_Hypnos::sleep(bool waitForSerial){
 
     // If it hasn't we should preform our sleep as before
     if(!hasAlarmTriggered){
+        // Interrupts that fired while awake are only kept if a handler still needs to count them
+        noInterrupts();
+        for(int i = 0; i < MAX_WAKE_SOURCES; i++){
+            if(wakeSources[i].handler == nullptr)
+                wakeReasons &= ~(1UL << i);
+        }
+        interrupts();
+        lastWakeReasons = 0;
+
         pre_sleep();                                            // Pre-sleep cleanup
         shouldPowerUp = true;
-        LowPower.sleep();                                       // Go to sleep and hang
+
+        // Wakes that the handlers deal with on their own go straight back to sleep without powering anything up
+        do{
+            LowPower.sleep();                                   // Go to sleep and hang
+        }while(handleWakeEvents());
         Watchdog.enable(WATCHDOG_TIMEOUT);
     }
     // If it has we want to trigger a resample which requires powering the sensors back up
@@ -506,14 +828,27 @@ void Loom_Hypnos::pre_sleep(){
     bool disable5 = is5VDisabled(DEVICE_STATE::ENTERING_SLEEP);
     bool disable33 = is3VDisabled(DEVICE_STATE::ENTERING_SLEEP);
     char output[OUTPUT_SIZE];
+
+    // Work handed to the executor never carries over a sleep, the SD card is powered off with the rails
+    if(sdMan != nullptr)
+        sdMan->finishBatchTrim();
+
+    // Read the time while I2C still works, wake handlers count on from it with the SAMD's RTC
+    sleepStartTime = getCurrentTime().unixtime();
+    startSleepClock();
+    asleep = true;
     delay(1000);
 
+    // Remember whether anyone is listening so fast wake knows if it needs to bring the USB back up
+    hostConnected = Serial;
+
     // Close the serial connection and detach
     Serial.end();
     USBDevice.detach();
 
-    // Reattach the interrupt to the RTC interrupt pin
-    attachInterrupt(digitalPinToInterrupt(pinToInterrupt.begin()->first), std::get<0>(pinToInterrupt.begin()->second), std::get<1>(pinToInterrupt.begin()->second));
+    // Reattach every registered interrupt so any of them can wake the device
+    for(auto& entry : pinToInterrupt)
+        attachInterrupt(digitalPinToInterrupt(entry.first), std::get<0>(entry.second), std::get<1>(entry.second));
 
     // Disable the power rails
     disable(disable33, disable5);
@@ -525,12 +860,22 @@ void Loom_Hypnos::post_sleep(bool waitForSerial){
     // Enable the Watchdog timer when waking up
     TIMER_ENABLE;
     Watchdog.reset();
+    unsigned long wakeStart = millis();
     
     if(shouldPowerUp){
-        USBDevice.attach();
-        Watchdog.reset();
-        Serial.begin(115200);
-        Watchdog.reset();
+
+        // Without a computer connected there is nothing to enumerate with, but still check every so often in case one was plugged in
+        bool attachUSB = !fastWake || hostConnected || waitForSerial;
+        if(!attachUSB && fullWakeInterval > 0 && ++wakesSinceUSB >= fullWakeInterval)
+            attachUSB = true;
+
+        if(attachUSB){
+            wakesSinceUSB = 0;
+            USBDevice.attach();
+            Watchdog.reset();
+            Serial.begin(115200);
+            Watchdog.reset();
+        }
 
         // Check if they are not disabled to see if they should be enabled
         bool enable5 = !is5VDisabled(DEVICE_STATE::EXITING_SLEEP);
@@ -538,9 +883,15 @@ void Loom_Hypnos::post_sleep(bool waitForSerial){
         bool enable33 = !is3VDisabled(DEVICE_STATE::EXITING_SLEEP);
         Watchdog.reset();
 
+        // Rails that stayed on through sleep don't need time to settle
+        bool railRestored = (enable33 && powerLost3V) || (enable5 && powerLost5V);
+
         enable(enable33, enable5); // Checks if the 3.3v or 5v are disabled and re-enables them
         Watchdog.reset();
-        delay(1000);
+
+        // Let the rails settle, anything scheduled on the executor runs in the meantime
+        if(!fastWake || railRestored)
+            Loom_Executor::getInstance()->wait(RAIL_SETTLE_TIME);
         Watchdog.reset();
 
         LOG(F("Device has awoken from sleep!"));
@@ -560,6 +911,12 @@ void Loom_Hypnos::post_sleep(bool waitForSerial){
             TIMER_ENABLE;
         }        
     }
+
+    // The rails and I2C are back so the DS3231 can be read directly again
+    asleep = false;
+
+    // Start timing the wake up, this is stopped when the manager starts measuring
+    manInst->setWakeTime(wakeStart);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -13,9 +13,24 @@
 #include "Hardware/Loom_Hypnos/SDManager.h"
 #include "Loom_Manager.h"
 
+#define RAIL_SETTLE_TIME 1000       // Milliseconds to wait after turning a power rail back on before using what is on it
+#define FULL_WAKE_INTERVAL 10       // When using fast wake the USB is re-attached every this many wakes to check for a newly connected computer
+#define MAX_WAKE_SOURCES 4          // Number of interrupts that can be registered with the Hypnos
+
+/* Drift compensation */
+#define TIME_SYNC_THRESHOLD 2.0     // Seconds of expected clock error before the time is synced over the network
+#define DEFAULT_DRIFT_PPM 2.0       // Assumed drift before one has been measured, the DS3231 is rated for +-2ppm
+#define MIN_DRIFT_INTERVAL 86400    // Seconds between syncs before the drift is estimated, the network time is only accurate to a second
+#define AGING_INTERVAL 259200       // Seconds of measurement before the drift is trimmed out using the aging offset
+#define AGING_PPM_PER_STEP 0.1      // Change in frequency per step of the DS3231 aging offset at 25C
+#define MAX_DRIFT_OFFSET 60         // An offset larger than this in seconds means the clock was set some other way so the measurement starts over
+
 // Used to pass along the user defined interrupt callback
 using InterruptCallbackFunction = void (*)();
 
+// Called after waking from an interrupt, returns true if the device should fully wake up or false to go straight back to sleep
+using WakeHandlerFunction = bool (*)();
+
 /**
  * Enum to represent all power rail configurations
  */
@@ -106,6 +121,9 @@ class Loom_Hypnos : public Module{
 
         // We want to use the package method to add the timestamp to the JSON
         void package() override;
+
+        // The timestamp object holds a copy of both time strings, plus the wake latency when using fast wake
+        size_t getPackageSize() override { return JSON_OBJECT_SIZE(2) + 2 * JSON_STRING_SIZE(21) + (fastWake ? MODULE_PACKAGE_SIZE(1) : 0); };
     public:
 
         volatile bool shouldPowerUp = true;
@@ -154,6 +172,15 @@ class Loom_Hypnos : public Module{
          */
         void setWakeConfiguration(POWERRAIL_CONFIG config) { wakeModePowerConfig = config; };
 
+        /**
+         * Only re-initialize what actually lost power while asleep
+         * The USB and Serial are skipped if no computer had the serial port open, the rails are only given time to settle and the SD card is only restarted if they were turned off
+         * The time from waking to the first measurement is added to the package as Wake_Latency
+         * @param enable Whether or not to use the fast wake path
+         * @param fullWakeInterval Re-attach the USB every this many wakes so a newly connected computer is noticed, 0 to never
+         */
+        void setFastWake(bool enable, uint16_t fullWakeInterval = FULL_WAKE_INTERVAL) { fastWake = enable; this->fullWakeInterval = fullWakeInterval; };
+
         /* SD Functionality */
 
         /**
@@ -172,6 +199,27 @@ class Loom_Hypnos : public Module{
          */
         bool registerInterrupt(InterruptCallbackFunction isrFunc = nullptr, int interruptPin = 12, HypnosInterruptType interruptType = SLEEP, int triggerState = LOW);
 
+        /**
+         * Set a handler to run when the given interrupt wakes the device, before anything is powered back up
+         * If every interrupt that woke the device has a handler and they all return false the device goes straight back to sleep, eg. counting tipping bucket pulses without powering the sensors
+         * Handlers run with the power rails off and without Serial so they should be short
+         * @param interruptPin Pin of a previously registered interrupt
+         * @param handler Function to call, return true to fully wake the device
+         */
+        bool registerWakeHandler(int interruptPin, WakeHandlerFunction handler);
+
+        /**
+         * Whether or not the given interrupt fired since the device last went to sleep
+         * @param interruptPin Pin of a previously registered interrupt
+         */
+        bool wokeFrom(int interruptPin);
+
+        /**
+         * Get the interrupts that fired since the device last went to sleep
+         * @return Bit mask where bit n is the nth registered interrupt
+         */
+        uint32_t getWakeReasons() { return lastWakeReasons; };
+
         /**
          * Called when the user wants to wake the Hypnos back out of the sleep state
          * This detaches the interrupt AND re-enables the power rails
@@ -190,6 +238,12 @@ class Loom_Hypnos : public Module{
          */
         void setInterruptDuration(const TimeSpan duration);
 
+        /**
+         * Set the next interrupt for when the next module with a schedule is due (see Module::setSchedule)
+         * @param maxDuration Longest time to sleep for, modules without a schedule are sampled at least this often
+         */
+        void setScheduledInterrupt(const TimeSpan maxDuration);
+
         /**
          * Drops the Feather M0 and Hypnos board into a low power sleep waiting for an interrupt to wake it up and pull it out of sleep
          * @param waitForSerial Whether or not we should wait for the user to open the serial monitor before continuing execution
@@ -201,6 +255,12 @@ class Loom_Hypnos : public Module{
          */
         DateTime getCurrentTime();
 
+        /**
+         * Get the current unix time, safe to call from a wake handler while the rails and I2C are off
+         * While asleep this is the RTC time read just before sleeping plus the seconds counted by the SAMD's own RTC, which keeps running in standby
+         */
+        uint32_t getUnixTime();
+
         /**
          * Convert the current time to a ISO 8601 compatible time string
          *
@@ -240,9 +300,29 @@ class Loom_Hypnos : public Module{
         /* Set a network interface in the Hypnos so we can sync our time */
         void setNetworkInterface(NetworkComponent* component) { networkComponent = component; };
 
-        /* Set the current RTC time to the time retrieved from the network */
+        /* Set the current RTC time to the time retrieved from the network, this also measures how fast the RTC drifts */
         bool networkTimeUpdate();
 
+        /**
+         * Sync the time whenever the network component is already connected and the expected clock error is above the threshold, the radio is never powered up just for the time
+         * Off by default, sketches that call networkTimeUpdate() themselves keep working as before
+         * @param enable Whether or not to sync automatically
+         * @param maxError Expected error in seconds before a sync is due
+         */
+        void setAutoTimeSync(bool enable, float maxError = TIME_SYNC_THRESHOLD) { autoTimeSync = enable; maxTimeError = maxError; };
+
+        /* Whether the expected clock error has grown past the sync threshold */
+        bool isTimeSyncDue() { return lastSyncTime == 0 || getExpectedTimeError() >= maxTimeError; };
+
+        /* How far off in seconds the clock could be by now given the drift and the time since the last sync */
+        float getExpectedTimeError();
+
+        /* Measured drift of the RTC in parts per million that hasn't been trimmed out with the aging offset, positive when running fast */
+        float getDriftPPM() { return driftPPM; };
+
+        /* Current DS3231 aging offset */
+        int8_t getAgingOffset() { return agingOffset; };
+
         /* Whether or not the current timezone is observing daylight savings */
         bool isDaylightSavings();
 
@@ -266,6 +346,15 @@ class Loom_Hypnos : public Module{
         // Power rail configuration for the when the device is asleep
         POWERRAIL_CONFIG sleepModePowerConfig = PR_3V_OFF_5V_OFF;
 
+        bool powerLost3V = true;                                                            // Whether the 3.3v rail has been off since the things on it were last initialized
+        bool powerLost5V = true;                                                            // Whether the 5v rail has been off since the things on it were last initialized
+
+        /* Fast wake */
+        bool fastWake = false;                                                              // Only re-initialize what lost power when waking
+        uint16_t fullWakeInterval = FULL_WAKE_INTERVAL;                                     // Wakes between USB re-attaches when no computer was connected
+        uint16_t wakesSinceUSB = 0;                                                         // Wakes since the USB was last attached
+        bool hostConnected = true;                                                          // Whether a computer had the serial port open before going to sleep
+
         /**
          * Based on the state we are entering determine the configuration of the 3V power rail
          * @param state The new state teh device is entering
@@ -293,8 +382,51 @@ class Loom_Hypnos : public Module{
 
         bool custom_time = false;                                                           // Set the RTC to a user specified time
 
+        /* Drift compensation */
+        bool autoTimeSync = false;                                                          // Sync the time when the network happens to be connected, opt-in with setAutoTimeSync()
+        float maxTimeError = TIME_SYNC_THRESHOLD;                                           // Expected error in seconds before a sync is due
+        uint32_t lastSyncTime = 0;                                                          // Network time of the last sync, 0 if never synced
+        uint32_t driftRefTime = 0;                                                          // Network time the drift is being measured from
+        int32_t driftCorrection = 0;                                                        // Seconds the RTC has been set back since the reference time
+        float driftPPM = 0;                                                                 // Drift left after the aging offset, positive when fast
+        bool driftKnown = false;                                                            // Whether the drift has been measured yet
+        int8_t agingOffset = 0;                                                             // Value in the DS3231 aging offset register
+
+        void updateDrift(DateTime networkTime);                                             // Update the drift estimate and set the RTC to the network time
+        bool readAgingOffset();                                                             // Read the aging offset from the RTC
+        bool writeAgingOffset(int8_t offset);                                               // Write the aging offset to the RTC
+
+        /* Sleep clock */
+        bool asleep = false;                                                                // Set from pre_sleep() until post_sleep() is done, the DS3231 can't be read while the rails are off
+        uint32_t sleepStartTime = 0;                                                        // Unix time read from the DS3231 just before going to sleep
+
+        void startSleepClock();                                                             // Start counting seconds on the SAMD's RTC from the 32kHz crystal
+        uint32_t readSleepClock();                                                          // Seconds counted since startSleepClock()
+
+        /* Wake sources */
+        struct WakeSource{
+            int pin = -1;                                                                   // Pin the interrupt is on, -1 if the slot is free
+            InterruptCallbackFunction isr = nullptr;                                        // User supplied ISR
+            WakeHandlerFunction handler = nullptr;                                          // Called after waking, null means always fully wake
+        };
+        static WakeSource wakeSources[MAX_WAKE_SOURCES];                                   // Registered interrupts, the index matches the bit in the wake reasons
+        static volatile uint32_t wakeReasons;                                               // Set by the interrupts as they fire
+        static const InterruptCallbackFunction wakeISRs[MAX_WAKE_SOURCES];                  // wakeISR for each slot
+        uint32_t lastWakeReasons = 0;                                                       // Everything that fired since the device last went to sleep
+
+        // Records which interrupt fired and then calls the user's ISR, one of these is attached in place of each user ISR
+        template<uint8_t SLOT>
+        static void wakeISR(){
+            wakeReasons |= (1UL << SLOT);
+            if(wakeSources[SLOT].isr != nullptr)
+                wakeSources[SLOT].isr();
+        };
+
+        int getWakeSlot(int interruptPin);                                                  // Get the wake source slot for the pin, -1 if not registered
+        bool handleWakeEvents();                                                            // Runs the wake handlers, returns true if the device should go back to sleep
+
         // Map the given pin to an interrupt call back
-        // 0th - ISR
+        // 0th - ISR (the wakeISR for the pin's slot)
         // 1st - Interrupt Trigger
         // 2nd - Interrupt Type (SLEEP or OTHER)
         std::map<int, std::tuple<InterruptCallbackFunction, int, HypnosInterruptType>> pinToInterrupt;
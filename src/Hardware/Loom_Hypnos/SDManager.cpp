@@ -62,11 +62,20 @@ void SDManager::writeHeaders(){
     // Loop over each 
     for(JsonVariant v : contentsArray) {
         // Get the module name
-        strncat(header1, v.as<JsonObject>()["module"].as<const char*>(), 512);
+        const char* moduleName = v.as<JsonObject>()["module"].as<const char*>();
+        strncat(header1, moduleName, 512);
 
         // Get all JSON keys  
         for(JsonPair keyValue : v.as<JsonObject>()["data"].as<JsonObject>()){
             strncat(header2, keyValue.key().c_str(), 512);
+
+            // Fixed-point fields record their scale in the column name so the values can be converted back (eg. Temperature/100)
+            uint32_t scale = manInst->getFieldScale(moduleName, keyValue.key().c_str());
+            if(scale > 1){
+                char scaleText[12];
+                snprintf_P(scaleText, 12, PSTR("/%lu"), (unsigned long)scale);
+                strncat(header2, scaleText, 512);
+            }
             strncat(header2, ",", 512);
             strncat(header1, ",", 512);
         }
@@ -79,9 +88,18 @@ void SDManager::writeHeaders(){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 bool SDManager::log(DateTime currentTime){
-    char output[MAX_JSON_SIZE + 1];
     
     if(sdInitialized){
+
+        // Modules were plugged in or removed so the old header no longer matches, start a new file
+        if(manInst->getCSVLayoutVersion() != csvLayoutVersion){
+            csvLayoutVersion = manInst->getCSVLayoutVersion();
+            finishBatchTrim();
+            if(root.open("/", O_RDONLY))
+                updateCurrentFileName();
+            else
+                ERROR(F("Failed to open root file system on SD Card, the new columns will be logged under the old header!"));
+        }
         
         // Open the file in read/write mode, create the file if we need to and append the content to the end of the file
         myFile = sd.open(fileName, O_RDWR | O_CREAT | O_APPEND);
@@ -96,61 +114,8 @@ bool SDManager::log(DateTime currentTime){
                 writeHeaders();
             }    
             
-            snprintf_P(output, MAX_JSON_SIZE, PSTR("%s,%i,"), manInst->get_device_name(), manInst->get_instance_num());
-            
-            // Write the Instance data that isn't included in the JSON packet
-            myFile.print(output);
-            memset(output, '\0', MAX_JSON_SIZE); // Clear array
-
-            JsonObject document = manInst->getDocument().as<JsonObject>();
-
-            // If there is a key that contains timestamp data when need to include that separately 
-            if(document.containsKey("timestamp")){
-                char utcArr[21];
-                char localArr[21];
-                memset(utcArr, '\0', 21);
-                memset(localArr, '\0', 21);
-                strncpy(utcArr, document["timestamp"]["time_utc"].as<const char*>(), 21);
-                strncpy(localArr, document["timestamp"]["time_local"].as<const char*>(), 21);
-
-                // Format date with spaces when logging to SD
-                char *indexPointer = strchr(utcArr, 'Z');
-                if(indexPointer != nullptr){
-                    utcArr[10] = ' ';
-                    utcArr[indexPointer-utcArr] = '\0';
-                }
-
-                
-                // Format date with spaces when logging to SD
-                indexPointer = strchr(localArr, 'Z');
-                if(indexPointer != nullptr){
-                    localArr[10] = ' ';
-                    localArr[indexPointer-localArr] = '\0';
-                }
-
-                // Format the time stamp in the CSV file
-                strncat(output, utcArr, MAX_JSON_SIZE);
-                strncat(output, ",", MAX_JSON_SIZE);
-                strncat(output, localArr, MAX_JSON_SIZE);
-                strncat(output, ",", MAX_JSON_SIZE);
-            }
-            
-
-            // Get the contents containing the reset of the sensor data
-            JsonArray contentsArray = document["contents"].as<JsonArray>();
-
-            // Loop over each 
-            for(JsonVariant v : contentsArray) {
-
-                // Get all JSON keys  
-                for(JsonPair keyValue : v.as<JsonObject>()["data"].as<JsonObject>()){
-                    strncat(output, keyValue.value().as<String>().c_str(), MAX_JSON_SIZE);
-                    strncat(output, ",", MAX_JSON_SIZE);
-                }
-            }
-
-            // Write the matching data into the CSV file
-            myFile.println(output);
+            // The manager builds the CSV row once per cycle, the same row is reused if anything else asks for it
+            myFile.println(manInst->getSerialized(FORMAT_CSV).data);
 
             // Set the last modified date
             myFile.timestamp(T_WRITE , currentTime.year(), currentTime.month(), currentTime.day(), currentTime.hour(), currentTime.minute(), currentTime.second());
@@ -159,8 +124,7 @@ bool SDManager::log(DateTime currentTime){
             myFile.close();
 
             // Inform the user that we have successfully written to the file
-            snprintf_P(output, MAX_JSON_SIZE, PSTR("Successfully logged data to %s"), fileName);
-            LOG(output);
+            LOGF("Successfully logged data to %s", fileName);
             
         }
         else{
@@ -212,8 +176,7 @@ bool SDManager::begin(){
             return false;
         }
         updateCurrentFileName();
-
-        
+        csvLayoutVersion = manInst->getCSVLayoutVersion();
     }
     
     // Once the SD card has initialized the first round through we don't want to update the file name
@@ -316,26 +279,103 @@ char* SDManager::readFile(const char* fileName){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void SDManager::logBatch(){
     char f_name[260];
-    char jsonString[MAX_JSON_SIZE];
     snprintf_P(f_name, 260, PSTR("%s-Batch.txt"), fileNameNoExtension);
-    // We want to clear the file after the batch size has been exceeded
-    if(current_batch >= batch_size){
+    // We want to clear the file once it has been sent
+    if(batchPublished){
+        // Everything in the file was sent so a trim that hasn't run yet has nothing left to do
+        Loom_Executor::getInstance()->cancelTask(trimTask);
+        trimPending = false;
+
         current_batch = 0;
+        batchPublished = false;
         myFile = sd.open(f_name, O_WRITE | O_TRUNC | O_APPEND);
     }
     else{
+        // A trim scheduled by the last log that no wait has run yet
+        finishBatchTrim();
         myFile = sd.open(f_name, O_WRITE | O_CREAT | O_APPEND);
     }
     // Check if the file has been opened properly and write the JSON packet to one line
     if(myFile){
       
-        manInst->getJSONString(jsonString);
-        myFile.println(jsonString);
+        manInst->writeJSON(myFile);
+        myFile.println();
         myFile.close();
         current_batch++;
+
+        // A deferred backlog that is full only loses its oldest batch, the file is rewritten in the background during the next wait (eg. the modem attaching) so it doesn't hold up this cycle
+        if(current_batch >= max(batch_size, batch_limit) && !trimPending){
+            trimPending = true;
+            trimTask = Loom_Executor::getInstance()->addTask(runBatchTrim, this);
+        }
         
     }else{
         printModuleName("Failed to open file!");
     }
 }
-//////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t SDManager::runBatchTrim(void* context){
+    ((SDManager*)context)->finishBatchTrim();
+    return TASK_COMPLETE;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void SDManager::finishBatchTrim(){
+    if(!trimPending)
+        return;
+
+    Loom_Executor::getInstance()->cancelTask(trimTask);
+    trimPending = false;
+    dropOldestBatch(getBatchFilename());
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void SDManager::dropOldestBatch(const char* fileName){
+    char tempName[260];
+    char buffer[64];
+    int linesToSkip = max(batch_size, 1);
+
+    WARNINGF("Batch backlog is full, dropping the oldest %i packets", linesToSkip);
+
+    // The file only holds one batch so there is nothing newer to keep
+    if(current_batch <= linesToSkip){
+        sd.remove(fileName);
+        current_batch = 0;
+        return;
+    }
+
+    snprintf_P(tempName, 260, PSTR("%s-Batch.tmp"), fileNameNoExtension);
+    File source = sd.open(fileName);
+    File dest = sd.open(tempName, O_WRITE | O_CREAT | O_TRUNC);
+    if(!source || !dest){
+        // Without room to copy the newer packets the only way to keep logging is to start over
+        ERROR(F("Failed to open the batch file to drop the oldest batch, clearing the backlog instead!"));
+        source.close();
+        dest.close();
+        sd.remove(fileName);
+        current_batch = 0;
+        return;
+    }
+
+    // Every packet is one line, skip the oldest batch of them and copy the rest across
+    while(linesToSkip > 0 && source.available()){
+        if(source.read() == '\n')
+            linesToSkip--;
+    }
+
+    int length;
+    while((length = source.read(buffer, sizeof(buffer))) > 0){
+        dest.write(buffer, length);
+    }
+
+    source.close();
+    dest.close();
+    sd.remove(fileName);
+    sd.rename(tempName, fileName);
+    current_batch = max(current_batch - max(batch_size, 1), 0);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -91,6 +91,12 @@ class SDManager : public Module{
          */ 
         bool fileExists(const char* fileName) { return sd.exists(fileName); };
 
+        /**
+         * Deletes a file
+         * @param fileName The name of the file to delete
+         */ 
+        bool removeFile(const char* fileName) { return sd.remove(fileName); };
+
         /**
          * Sets the batch size and thus enables batch loggin
          */ 
@@ -101,6 +107,22 @@ class SDManager : public Module{
          */ 
         int getCurrentBatch() { return current_batch; };
 
+        /**
+         * Let the batch file grow past the batch size when an upload is deferred
+         * @param limit Most packets kept in the batch file before it is cleared, the batch size is used if this is smaller
+         */
+        void setBatchLimit(int limit) { batch_limit = limit; };
+
+        /**
+         * Called once the batch has been sent so the next log starts a new batch
+         */
+        void markBatchPublished() { batchPublished = true; };
+
+        /**
+         * Drop the oldest batch now if a full backlog is still waiting to be trimmed, called before the batch file is read and before sleeping
+         */
+        void finishBatchTrim();
+
         /**
          * Log to a different name other than one matching the device name
          */ 
@@ -133,13 +155,20 @@ class SDManager : public Module{
 
         int batch_size = -1;                                    // How many packets to log per batch
         int current_batch = 0;                                  // Current count of the batch
+        int batch_limit = -1;                                   // Most packets kept in the batch file, -1 to use the batch size
+        bool batchPublished = false;                            // Whether the current batch has been sent
+        bool trimPending = false;                               // Whether the full backlog still has to drop its oldest batch
+        int trimTask = -1;                                      // Executor task that drops it during the next wait
         int file_count = 0;                                     // What file number are we logging to
 
         bool sdInitialized = false;                             // If the SD card actually initialized
+        uint16_t csvLayoutVersion = 0;                          // CSV layout the current file's header was written for
         char* headers[2];                                       // Contains the main and sub headers that are added to the top of the CSV files
 
 
         void logBatch();                                        // Log data in batch format
+        void dropOldestBatch(const char* fileName);             // Rewrite the batch file without its oldest batch so a deferred backlog keeps the newest packets
+        static uint32_t runBatchTrim(void* context);            // Executor task that runs finishBatchTrim()
         
         void writeHeaders();                                   // Create the headers for the CSV file based off what info we are storing
         bool updateCurrentFileName();                           // Update the current file name to log to based on files already existing on the SD card
@@ -1,24 +1,31 @@
 #include "Loom_Multiplexer.h"
 #include "Logger.h"
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Loom_Multiplexer::Loom_Multiplexer(Manager& man) : Module("Multiplexer"), manInst(&man) {
+Loom_Multiplexer::Loom_Multiplexer(Manager& man) : Module("Multiplexer"), manInst(&man), sensorTypes(MUX_ALL_SENSORS), sensorTypeCount(sizeof(MUX_ALL_SENSORS) / sizeof(MuxSensorType)) {
     moduleInitialized = false;
     manInst->registerModule(this);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Loom_Multiplexer::Loom_Multiplexer(Manager& man, const std::vector<byte>& addresses) : Module("Multiplexer"), manInst(&man){
+Loom_Multiplexer::Loom_Multiplexer(Manager& man, const std::vector<byte>& addresses) : Module("Multiplexer"), manInst(&man), sensorTypes(MUX_ALL_SENSORS), sensorTypeCount(sizeof(MUX_ALL_SENSORS) / sizeof(MuxSensorType)){
     moduleInitialized = false;
     manInst->registerModule(this);
     known_addresses = addresses;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+Loom_Multiplexer::Loom_Multiplexer(Manager& man, const MuxSensorType* types, uint8_t typeCount) : Module("Multiplexer"), manInst(&man), sensorTypes(types), sensorTypeCount(typeCount){
+    moduleInitialized = false;
+    manInst->registerModule(this);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 Loom_Multiplexer::~Loom_Multiplexer()  {
     for(int i = 0; i < sensors.size(); i++){
-        delete std::get<1>(sensors[i]);
+        delete sensors[i].module;
     }
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -28,7 +35,7 @@ void Loom_Multiplexer::initialize(){
     FUNCTION_START;
     char output[OUTPUT_SIZE];
     Wire.begin();
-    int moduleIndex = 0;
+
     // Find the multiplexer at the possible addresses
     for(byte addr : alt_addresses){
 
@@ -39,31 +46,20 @@ void Loom_Multiplexer::initialize(){
             activeMuxAddr = addr;
             moduleInitialized = true;
 
-            moduleIndex = 0;
-            // Load the sensors for the first time
-            for(int i = 0; i < numPorts; i++){
-                selectPin(i);
+            // Work out which addresses are worth probing once instead of on every port
+            buildScanAddresses();
 
-                // Loop over address that we know to speed up refreshing
-                for(byte addr : known_addresses){
-
-                    if(addr > 0){
-                        // Is there any device at this address
-                        if(isDeviceConnected(addr)){
-                            snprintf(output, OUTPUT_SIZE, "Found I2C Device on Pin %i at address %x", i, addr);
-                            LOG(output);
-
-                            sensors.push_back(std::make_tuple(addr, loadSensor(addr), i));
+            // Load the sensors for the first time, the ports are scanned in order so the sensor list stays sorted by port
+            for(int i = 0; i < numPorts; i++){
+                selectPort(i, false);
 
-                            // Initialize connected sensor
-                            snprintf(output, OUTPUT_SIZE, "%s_%i", std::get<1>(sensors[moduleIndex])->getModuleName(), i);
-                            std::get<1>(sensors[moduleIndex])->setModuleName(output);
-                            std::get<1>(sensors[moduleIndex])->initialize();
+                for(byte sensorAddr : scanAddresses){
 
-                            snprintf(output, OUTPUT_SIZE, "Loaded sensor %s on port %i", std::get<1>(sensors[moduleIndex])->getModuleName(), i);
-                            LOG(output);
-                            moduleIndex++;
-                        }
+                    // Is there any device at this address
+                    if(isDeviceConnected(sensorAddr)){
+                        snprintf(output, OUTPUT_SIZE, "Found I2C Device on Pin %i at address %x", i, sensorAddr);
+                        LOG(output);
+                        addSensor(i, sensorAddr);
                     }
                 }
             }
@@ -83,78 +79,233 @@ void Loom_Multiplexer::initialize(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-void Loom_Multiplexer::refreshSensors(){
-    FUNCTION_START;
+void Loom_Multiplexer::buildScanAddresses(){
     char output[OUTPUT_SIZE];
-    int moduleIndex = 0;
-
-    // Cycle through the mux ports
-    for(int i = 0; i < numPorts; i++){
-        selectPin(i);
-        delay(50);
-       
-        // Loop over address that we know to speed up refreshing
-        for(byte addr : known_addresses){
-
-            // Is there any device at this address
-            if(isDeviceConnected(addr) && addr > 0){
-
-                // If it was a new sensor plugged in then load a new sensor over top
-                if(std::get<1>(sensors[moduleIndex])->module_address != addr){
-                    delete std::get<1>(sensors[moduleIndex]);
-                    sensors[moduleIndex] = std::make_tuple(addr, loadSensor(addr), i);
-
-                    // Initialize the new sensor
-                    snprintf(output, OUTPUT_SIZE, "New sensor detected on port %i at I2C address %x of type %s", i, addr, std::get<1>(sensors[moduleIndex])->getModuleName());
-                    LOG(output);
-                    
-                    // Update name for unique instances in the Mux
-                    snprintf(output, OUTPUT_SIZE, "%s_%i", std::get<1>(sensors[moduleIndex])->getModuleName(), i);
-                    std::get<1>(sensors[moduleIndex])->setModuleName(output);
-                    std::get<1>(sensors[moduleIndex])->initialize();
-                }
-                moduleIndex++;
+
+    // Without a list of addresses every address one of the sensor types can be at is checked
+    std::vector<byte> candidates = known_addresses;
+    if(candidates.empty()){
+        for(int i = 0; i < sensorTypeCount; i++){
+            for(byte addr : sensorTypes[i].addresses){
+                if(addr > 0 && std::find(candidates.begin(), candidates.end(), addr) == candidates.end())
+                    candidates.push_back(addr);
             }
         }
-        
     }
+
+    // Anything that answers with every channel off is on the main bus (e.g. the Hypnos RTC) and would show up on every port
+    disableChannels();
+    scanAddresses.clear();
+    for(byte addr : candidates){
+        if(addr == 0)
+            continue;
+
+        if(isDeviceConnected(addr)){
+            snprintf(output, OUTPUT_SIZE, "Address %x is in use on the main bus, it won't be scanned behind the multiplexer", addr);
+            WARNING(output);
+            continue;
+        }
+        scanAddresses.push_back(addr);
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Multiplexer::scanForNewSensors(){
+    FUNCTION_START;
+    char output[OUTPUT_SIZE];
+    uint16_t pairs = numPorts * scanAddresses.size();
+    uint8_t probes = 0;
+    bool added = false;
+
+    // Walk the ports in order so consecutive probes usually share a port, pairs that already have a sensor are skipped for free
+    for(uint16_t step = 0; step < pairs && probes < MUX_SCAN_PROBES; step++){
+        scanCursor = (scanCursor + 1) % pairs;
+        uint8_t port = scanCursor / scanAddresses.size();
+        byte addr = scanAddresses[scanCursor % scanAddresses.size()];
+
+        if(findSensor(port, addr) >= 0)
+            continue;
+
+        probes++;
+        selectPort(port, false);
+        if(isDeviceConnected(addr)){
+            snprintf(output, OUTPUT_SIZE, "New sensor detected on port %i at I2C address %x", port, addr);
+            LOG(output);
+            added |= addSensor(port, addr);
+        }
+    }
+
+    // The last port probed was switched on without waiting, make sure the measurement settles it
+    selectedPort = MUX_NO_PORT;
+
+    // The new sensor's columns weren't in the CSV header
+    if(added)
+        manInst->resetCSVLayout();
     FUNCTION_END;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-void Loom_Multiplexer::measure(){
+bool Loom_Multiplexer::addSensor(uint8_t port, byte addr){
+    char output[OUTPUT_SIZE];
+
+    Module* module = loadSensor(addr);
+    if(module == nullptr){
+        snprintf(output, OUTPUT_SIZE, "No driver available for the device at address %x on port %i", addr, port);
+        WARNING(output);
+        return false;
+    }
+
+    // Update name for unique instances in the Mux
+    snprintf(output, OUTPUT_SIZE, "%s_%i", module->getModuleName(), port);
+    module->setModuleName(output);
+
+    // Insert after every sensor on the same or an earlier port so the table stays in port order
+    int index = 0;
+    while(index < sensors.size() && sensors[index].port <= port)
+        index++;
+    MuxSensor sensor = {port, addr, module, getSettleTime(addr), true, true, 0};
+    sensors.insert(sensors.begin() + index, sensor);
+
+    // The port was switched on without waiting while probing, switch it on again so the new sensor gets its settle time before it is initialized
+    selectedPort = MUX_NO_PORT;
+    selectPort(port);
+    module->initialize();
+
+    snprintf(output, OUTPUT_SIZE, "Loaded sensor %s on port %i", module->getModuleName(), port);
+    LOG(output);
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+int Loom_Multiplexer::findSensor(uint8_t port, byte addr){
+    for(int i = 0; i < sensors.size(); i++){
+        if(sensors[i].port == port && sensors[i].address == addr)
+            return i;
+    }
+    return -1;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Multiplexer::startMeasurement(){
     FUNCTION_START;
+    char output[OUTPUT_SIZE];
 
-    // Refresh sensors before measuring
-    // refreshSensors();
+    // The mux may have lost power since the last cycle so don't trust the selected port
+    selectedPort = MUX_NO_PORT;
 
+    // Pick up a few of the sensors that may have been plugged in since the last cycle
+    if(hotSwap && moduleInitialized && !scanAddresses.empty())
+        scanForNewSensors();
+
+    // Start every sensor's conversion so they all run at the same time, sensors are in port order so each port is only switched on once
     for(int i = 0; i < sensors.size(); i++){
-        selectPin(std::get<2>(sensors[i]));
-        delay(50);
-        std::get<1>(sensors[i])->measure();
+        sensors[i].collected = false;
+        selectPort(sensors[i].port);
+
+        // One probe while the port is already on tells us if the sensor was unplugged
+        if(hotSwap && !isDeviceConnected(sensors[i].address)){
+            if(++sensors[i].missedProbes >= MUX_MISSED_PROBES){
+                snprintf(output, OUTPUT_SIZE, "Sensor %s was removed from port %i", sensors[i].module->getModuleName(), sensors[i].port);
+                LOG(output);
+                delete sensors[i].module;
+                sensors.erase(sensors.begin() + i);
+                i--;
+
+                // The SD card starts a new file so the header drops its columns
+                manInst->resetCSVLayout();
+                continue;
+            }
+
+            // Don't wait on a sensor that isn't answering and don't send its last values again
+            sensors[i].collected = true;
+            sensors[i].present = false;
+            continue;
+        }
+
+        sensors[i].missedProbes = 0;
+        sensors[i].present = true;
+        sensors[i].module->startMeasurement();
     }
     FUNCTION_END;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_Multiplexer::isMeasurementReady(){
+    bool allCollected = true;
+
+    // Collect each sensor as soon as it finishes, the channel was already settled when the conversion was started
+    for(int i = 0; i < sensors.size(); i++){
+        if(sensors[i].collected)
+            continue;
+
+        selectPort(sensors[i].port, false);
+        if(sensors[i].module->isMeasurementReady()){
+            sensors[i].module->collectMeasurement();
+            sensors[i].collected = true;
+        }
+        else{
+            allCollected = false;
+        }
+    }
+    return allCollected;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Multiplexer::collectMeasurement(){
+    for(int i = 0; i < sensors.size(); i++){
+        if(!sensors[i].collected){
+            selectPort(sensors[i].port, false);
+            sensors[i].module->collectMeasurement();
+            sensors[i].collected = true;
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_Multiplexer::package(){
     FUNCTION_START;
     for(int i = 0; i < sensors.size(); i++){
-        std::get<1>(sensors[i])->package();
+        if(sensors[i].present)
+            sensors[i].module->package();
     }
     FUNCTION_END;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t Loom_Multiplexer::getPackageSize(){
+    size_t size = 0;
+    size_t largest = MODULE_PACKAGE_SIZE(DEFAULT_PACKAGE_FIELDS);
+    for(int i = 0; i < sensors.size(); i++){
+        size_t sensorSize = sensors[i].module->getPackageSize();
+        size += sensorSize;
+        largest = max(largest, sensorSize);
+    }
+
+    // The document is sized once so leave room for a few sensors being plugged in later
+    if(hotSwap)
+        size += MUX_SPARE_SENSORS * largest;
+
+    return size;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_Multiplexer::power_up(){
     FUNCTION_START;
+
+    // The mux was most likely powered off while asleep
+    selectedPort = MUX_NO_PORT;
     for(int i = 0; i < sensors.size(); i++){
-        selectPin(std::get<2>(sensors[i]));
-        delay(50);
-        std::get<1>(sensors[i])->power_up();
+        selectPort(sensors[i].port);
+        sensors[i].module->power_up();
     }
     FUNCTION_END;
 }
@@ -164,33 +315,78 @@ void Loom_Multiplexer::power_up(){
 void Loom_Multiplexer::power_down(){
     FUNCTION_START;
     for(int i = 0; i < sensors.size(); i++){
-        selectPin(std::get<2>(sensors[i]));
-        delay(50);
-        std::get<1>(sensors[i])->power_down();
+        selectPort(sensors[i].port);
+        sensors[i].module->power_down();
     }
     FUNCTION_END;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Multiplexer::setSettleTime(byte addr, uint16_t settleTime){
+    for(int i = 0; i < sensors.size(); i++){
+        if(sensors[i].address == addr)
+            sensors[i].settleTime = settleTime;
+    }
+
+    for(int i = 0; i < settleTimes.size(); i++){
+        if(settleTimes[i].first == addr){
+            settleTimes[i].second = settleTime;
+            return;
+        }
+    }
+    settleTimes.push_back(std::make_pair(addr, settleTime));
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint16_t Loom_Multiplexer::getSettleTime(byte addr){
+    for(int i = 0; i < settleTimes.size(); i++){
+        if(settleTimes[i].first == addr)
+            return settleTimes[i].second;
+    }
+    return MUX_SETTLE_TIME;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_Multiplexer::selectPin(uint8_t pin){
     FUNCTION_START;
     // Pin not in range
     if(pin > 7) return;
 
-    Wire.beginTransmission(activeMuxAddr);
-    Wire.write(1 << pin);
-    Wire.endTransmission();
+    uint8_t channel = 1 << pin;
+    Loom_I2CBus::getInstance()->write(activeMuxAddr, &channel, 1);
     FUNCTION_END;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Multiplexer::selectPort(uint8_t port, bool settle){
+    if(port == selectedPort)
+        return;
+
+    selectPin(port);
+    selectedPort = port;
+
+    // Wait once for the slowest sensor on the port
+    if(settle){
+        uint16_t settleTime = 0;
+        for(int i = 0; i < sensors.size(); i++){
+            if(sensors[i].port == port)
+                settleTime = max(settleTime, sensors[i].settleTime);
+        }
+        Loom_Executor::getInstance()->wait(settleTime);
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_Multiplexer::disableChannels(){
     FUNCTION_START;
-    Wire.beginTransmission(activeMuxAddr);
-    Wire.write(0);
-    Wire.endTransmission();
+    uint8_t channel = 0;
+    Loom_I2CBus::getInstance()->write(activeMuxAddr, &channel, 1);
+    selectedPort = MUX_NO_PORT;
     FUNCTION_END;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -198,10 +394,7 @@ void Loom_Multiplexer::disableChannels(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 bool Loom_Multiplexer::isDeviceConnected(byte addr){
     FUNCTION_START;
-    Wire.beginTransmission(addr);
-
-    // If end transmission returns 0 there is a device there
-    bool response = Wire.endTransmission() == 0;
+    bool response = Loom_I2CBus::getInstance()->probe(addr);
     FUNCTION_END;
     return response;
 }
@@ -209,51 +402,24 @@ bool Loom_Multiplexer::isDeviceConnected(byte addr){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 Module* Loom_Multiplexer::loadSensor(const byte addr){
+    char output[OUTPUT_SIZE];
 
-    // Select the correct sensor to load based on the address
-    switch (addr){
-        //TSL2591
-        case 0x29: return new Loom_TSL2591(*manInst, 0x29, true);
-
-        // ZX Gesture
-        case 0x10: return new Loom_ZXGesture(*manInst, 0x10, true);
-        case 0x11: return new Loom_ZXGesture(*manInst, 0x11, true);
-
-        // SHT31
-        case 0x44: return new Loom_SHT31(*manInst, 0x44, true);
-        case 0x45: return new Loom_SHT31(*manInst, 0x45, true);
-
-        // ADS1115  
-        case 0x48: return new Loom_ADS1115(*manInst, 0x48, true);
-
-        // K30 - 
-        case 0x68: return new Loom_K30(*manInst, true, 0x68, true);
-
-        //MMA8451
-        case 0x1D: return new Loom_MMA8451(*manInst, 0x1D, true);
-
-        //Loom_DFMultiGasSensor
-        case 0x74: return new Loom_DFMultiGasSensor(*manInst, 0x74, 10,false, true);
-        case 0x75: return new Loom_DFMultiGasSensor(*manInst, 0x75, 10,false, true);
-
-        // Loom_T6793
-        case 0x15: return new Loom_T6793(*manInst, 0x15, 10, true);
-
-        // MPU6050
-        // case 0x69: return new Loom_MPU6050(*manInst,  true);
-
-        // SEN55
-        case 0x69: return new Loom_SEN55(*manInst,0x69, true);
-
-        // MS5803
-        case 0x76: return new Loom_MS5803(*manInst, 0x76, true);
-        case 0x77: return new Loom_MS5803(*manInst, 0x77, true);
-
-        // STEMMA
-        case 0x36: return new Loom_STEMMA(*manInst, 0x36, true);
-
-        /// MB1232
-        case 0x70: return new Loom_MB1232(*manInst, 0x70, true);
+    // Types that can check the device's identity go first so an address shared by two sensors goes to the right driver, types without a probe are the fallback
+    for(int pass = 0; pass < 2; pass++){
+        for(int i = 0; i < sensorTypeCount; i++){
+            const MuxSensorType& type = sensorTypes[i];
+            bool hasProbe = type.identify != nullptr;
+            if(hasProbe != (pass == 0) || std::find(std::begin(type.addresses), std::end(type.addresses), addr) == std::end(type.addresses))
+                continue;
+
+            if(!hasProbe || type.identify(addr)){
+                snprintf(output, OUTPUT_SIZE, "Device at address %x identified as %s", addr, type.name);
+                LOG(output);
+                return type.create(*manInst, addr);
+            }
+        }
     }
+
+    return nullptr;
 }
-//////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -4,30 +4,42 @@
 #include "../../Module.h"
 
 #include <vector>
-#include <tuple>
 #include <algorithm>
 #include "Wire.h"
 
-// I2C Sensors Used by Loom
-#include "../../Sensors/I2C/Loom_ADS1115/Loom_ADS1115.h"
-#include "../../Sensors/I2C/Loom_MPU6050/Loom_MPU6050.h"
-#include "../../Sensors/I2C/Loom_MS5803/Loom_MS5803.h"
-#include "../../Sensors/I2C/Loom_SHT31/Loom_SHT31.h"
-#include "../../Sensors/I2C/Loom_TSL2591/Loom_TSL2591.h"
-#include "../../Sensors/I2C/Loom_STEMMA/Loom_STEMMA.h"
-#include "../../Sensors/I2C/Loom_MB1232/Loom_MB1232.h"
-#include "../../Sensors/I2C/Loom_K30/Loom_K30.h"
-#include "../../Sensors/I2C/Loom_MMA8451/Loom_MMA8451.h"
-#include "../../Sensors/I2C/Loom_ZXGesture/Loom_ZXGesture.h"
-#include "../../Sensors/I2C/Loom_DFMultiGasSensor/Loom_DFMultiGasSensor.h"
-#include "../../Sensors/I2C/Loom_T6793/Loom_T6793.h"
-#include "../../Sensors/I2C/Loom_SEN55/Loom_SEN55.h"
+#include "Loom_MuxSensors.h"
+#include "Loom_I2CBus.h"
 
+/* Multiplexer Setup */
+#ifndef MUX_SETTLE_TIME
+	#define MUX_SETTLE_TIME 5									// Default milliseconds a sensor is given after its channel is switched on
+#endif
+
+#ifndef MUX_SCAN_PROBES
+	#define MUX_SCAN_PROBES 4									// Empty port/address pairs probed for new sensors each cycle, the whole mux is covered over several cycles
+#endif
+
+#define MUX_MISSED_PROBES 2										// Consecutive cycles a sensor has to be missing before it is removed
+#define MUX_SPARE_SENSORS 2										// Sensors that can be plugged in after initialize() with room left for them in the package
+#define MUX_NO_PORT 0xFF										// Selected port when no channel is known to be enabled
+
+/**
+ * A sensor found on one of the multiplexer's ports
+ */
+struct MuxSensor{
+	uint8_t port;												// Port the sensor is on
+	byte address;												// I2C address of the sensor
+	Module* module;												// Driver loaded for the sensor
+	uint16_t settleTime;										// Milliseconds the sensor needs after its channel is switched on
+	bool collected;												// Whether the sensor has been collected in the current measurement
+	bool present;												// Whether the sensor answered its last probe, sensors that didn't aren't packaged
+	uint8_t missedProbes;										// Consecutive cycles the sensor didn't answer
+};
 
 /**
  * Adds Hot Swappable functionality for TCA9548 multiplexer
  * 
- * NOTE: This significantly increases flash size and resulting storage used
+ * NOTE: Every supported driver is linked in unless the multiplexer is given only the sensor types it needs, e.g. {MUX_SHT31, MUX_TSL2591}
  * 
  * @author Will Richards
  */ 
@@ -36,8 +48,12 @@ class Loom_Multiplexer : public Module{
 
 		/* Loomified generalized calls*/
 		void initialize() override;
-		void measure() override;
+		void measure() override { runMeasurement(); };
+		void startMeasurement() override;						// Starts the conversion on every sensor
+		bool isMeasurementReady() override;						// Collects each sensor as it finishes, true once all of them have been collected
+		void collectMeasurement() override;						// Collects any sensors that haven't finished yet, used when the manager times out
 		void package() override;
+		size_t getPackageSize() override;						// Sum of the package sizes of every sensor found on the mux
 		void power_down() override; 
 		void power_up() override;
 
@@ -56,53 +72,77 @@ class Loom_Multiplexer : public Module{
          */ 
         Loom_Multiplexer(Manager& man, const std::vector<byte>& addresses);
 
+		/**
+		 * Construct a new Multiplexer that only loads the given sensor types
+		 *
+		 * @param man Reference to the manager
+		 * @param types Sensor types that can be loaded, e.g. {MUX_SHT31, MUX_TSL2591}, must outlive the multiplexer
+		 * @param typeCount Number of sensor types
+		 */
+		Loom_Multiplexer(Manager& man, const MuxSensorType* types, uint8_t typeCount);
+
+		/**
+		 * Construct a new Multiplexer that only loads the sensor types in the given array
+		 *
+		 * @param man Reference to the manager
+		 * @param types Array of sensor types that can be loaded, must outlive the multiplexer
+		 */
+		template<size_t N>
+		Loom_Multiplexer(Manager& man, const MuxSensorType (&types)[N]) : Loom_Multiplexer(man, types, N) {};
+
 		// Destructor removes all new sensor instances
 		~Loom_Multiplexer();
+
+		/**
+		 * Set how long a sensor needs after its channel is switched on before it can be talked to
+		 * The channel waits for the slowest sensor on it and only when it is switched, sensors that share a port share the wait
+		 * @param addr I2C address of the sensor
+		 * @param settleTime Milliseconds to wait
+		 */
+		void setSettleTime(byte addr, uint16_t settleTime);
+
+		/**
+		 * Check for sensors being plugged in or unplugged while running, on by default
+		 * Each sensor is probed once a cycle while its port is already on and a few empty port/address pairs are probed for new sensors so nothing ever pays for a full scan
+		 * A sensor that misses a probe is left out of the package, when a sensor is added or removed the SD card starts a new file with a header for the new set of sensors
+		 * @param enable Whether or not to check for swapped sensors
+		 */
+		void setHotSwap(bool enable) { hotSwap = enable; };
         
     private:
         Manager* manInst;                                       // Instance of the manager
 		byte activeMuxAddr;										// The port which we want to try to communicate over
 		const uint8_t numPorts = 8;								// Number of ports on the multiplexer
+		uint8_t selectedPort = MUX_NO_PORT;						// Port currently switched on
 
-		std::vector<std::tuple<byte, Module*, int>> sensors;			// List of sensors
+		const MuxSensorType* sensorTypes;						// Sensor types that can be loaded
+		uint8_t sensorTypeCount;								// Number of sensor types
+
+		std::vector<MuxSensor> sensors;							// Sensors on the mux, kept in port order so each port is only switched on once per pass
+		std::vector<byte> scanAddresses;						// Addresses worth probing on each port, the known addresses (or those of the sensor types) minus anything that answers on the main bus
+		std::vector<std::pair<byte, uint16_t>> settleTimes;		// Settle times that differ from MUX_SETTLE_TIME
+
+		bool hotSwap = true;									// Whether or not to check for swapped sensors each cycle
+		uint16_t scanCursor = 0;								// Next port/address pair to probe for new sensors
 
         void selectPin(uint8_t pin);                            // Select which pin of the multiplexer to transmit to
+		void selectPort(uint8_t port, bool settle = true);		// Switch to a port only if it isn't already on, waiting for the sensors on it to settle
+		uint16_t getSettleTime(byte addr);						// How long a sensor at the given address needs after its channel is switched on
 		void disableChannels();									// Disables all channels on the Multiplexer
 		bool isDeviceConnected(byte addr);						// Check if there is a device at the specified address
+		void buildScanAddresses();								// Work out which addresses need to be probed behind the mux
 
-		void refreshSensors();									// Checks to see if any new sensors were swapped in allows for hot swapping
-		Module* loadSensor(const byte addr);					// Load the correct sensor based on the I2C address
+		void scanForNewSensors();								// Probe the next few empty port/address pairs for sensors that were plugged in
+		bool addSensor(uint8_t port, byte addr);				// Load and initialize a sensor, keeping the table in port order, false if there is no driver for it
+		int findSensor(uint8_t port, byte addr);				// Index of the sensor at the given port and address, -1 if there isn't one
+		Module* loadSensor(const byte addr);					// Load the correct sensor based on the I2C address and identity probes, nullptr if no type matches
 
 		std::vector<byte> known_addresses = {};
 
-		// Used to optimize searching for sensors:
-		// search addresses in array rather than 0-127 
-		const std::vector<byte> default_addresses = 
-		{
-			0x10, ///< ZXGESTURESENSOR
-			0x11, ///< ZXGESTURESENSOR
-			0x15, ///< T6793
-			0x19, ///< LIS3DH
-			0x1C, ///< MMA8451
-			0x1D, ///< MMA8451
-			0x29, ///< TSL2591
-			0x36, ///< STEMMA
-			0x44, ///< SHT31D
-			0x45, ///< SHT31D
-			0x48, ///< ADS1115
-			0x49, ///< AS726X / AS7265X
-			0x68, ///< K30
-			0x69, ///< SEN55
-			0x70, ///< MB1232
-			0x74, ///< DFMultiGasSensor
-			0x76, ///< MS5803
-			0x77  ///< MS5803
-		};
-
 		/**
 		 * Possible alternate addresses for the TCA9548
 		 */ 
-		const std::array<byte, 9>  alt_addresses = {
+		const std::array<byte, 6>  alt_addresses = {
 			0x71,
 			0x72,
 			0x73,
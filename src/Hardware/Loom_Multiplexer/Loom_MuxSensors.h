@@ -0,0 +1,115 @@
+#pragma once
+
+#include "../../Loom_Manager.h"
+#include "../../Module.h"
+#include "Loom_I2CBus.h"
+
+// I2C Sensors Used by Loom
+#include "../../Sensors/I2C/Loom_ADS1115/Loom_ADS1115.h"
+#include "../../Sensors/I2C/Loom_MPU6050/Loom_MPU6050.h"
+#include "../../Sensors/I2C/Loom_MS5803/Loom_MS5803.h"
+#include "../../Sensors/I2C/Loom_SHT31/Loom_SHT31.h"
+#include "../../Sensors/I2C/Loom_TSL2591/Loom_TSL2591.h"
+#include "../../Sensors/I2C/Loom_STEMMA/Loom_STEMMA.h"
+#include "../../Sensors/I2C/Loom_MB1232/Loom_MB1232.h"
+#include "../../Sensors/I2C/Loom_K30/Loom_K30.h"
+#include "../../Sensors/I2C/Loom_MMA8451/Loom_MMA8451.h"
+#include "../../Sensors/I2C/Loom_ZXGesture/Loom_ZXGesture.h"
+#include "../../Sensors/I2C/Loom_DFMultiGasSensor/Loom_DFMultiGasSensor.h"
+#include "../../Sensors/I2C/Loom_T6793/Loom_T6793.h"
+#include "../../Sensors/I2C/Loom_SEN55/Loom_SEN55.h"
+
+#define MUX_TYPE_ADDRESSES 4                // Most addresses one sensor type can be at
+
+/**
+ * A sensor the multiplexer knows how to load
+ * Only the drivers of the types handed to the multiplexer are referenced, so only those get linked in
+ */
+struct MuxSensorType{
+    const char* name;                                   // Name of the sensor, used when logging
+    byte addresses[MUX_TYPE_ADDRESSES];                 // Addresses the sensor can be at, unused entries are 0
+    bool (*identify)(byte addr);                        // Confirms the device at the address is this sensor, nullptr if the address alone is enough
+    Module* (*create)(Manager& man, byte addr);         // Construct the driver for the sensor at the given address
+};
+
+/* Identity probes, run with the sensor's port already selected */
+
+// WHO_AM_I reads 0x68 whatever AD0 is set to
+inline bool identifyMPU6050(byte addr){
+    uint8_t reg = 0x75, id = 0;
+    return Loom_I2CBus::getInstance()->transfer(addr, &reg, 1, &id, 1) && id == 0x68;
+}
+
+// WHO_AM_I
+inline bool identifyMMA8451(byte addr){
+    uint8_t reg = 0x0D, id = 0;
+    return Loom_I2CBus::getInstance()->transfer(addr, &reg, 1, &id, 1) && id == 0x1A;
+}
+
+// ID register, read through the command register
+inline bool identifyTSL2591(byte addr){
+    uint8_t reg = 0xA0 | 0x12, id = 0;
+    return Loom_I2CBus::getInstance()->transfer(addr, &reg, 1, &id, 1) && id == 0x50;
+}
+
+// Product name, sent back as "SEN55" with a CRC after every second character
+inline bool identifySEN55(byte addr){
+    const uint8_t command[2] = {0xD0, 0x14};
+    uint8_t name[6] = {0};
+    if(!Loom_I2CBus::getInstance()->write(addr, command, 2))
+        return false;
+
+    // The sensor needs 20ms to put the response together
+    Loom_Executor::getInstance()->wait(20);
+    if(!Loom_I2CBus::getInstance()->read(addr, name, 6))
+        return false;
+
+    return name[0] == 'S' && name[1] == 'E' && name[3] == 'N' && name[4] == '5';
+}
+
+/* Factories, every driver is constructed as being behind the mux so it doesn't register itself with the manager */
+inline Module* createTSL2591(Manager& man, byte addr)          { return new Loom_TSL2591(man, addr, true); }
+inline Module* createZXGesture(Manager& man, byte addr)        { return new Loom_ZXGesture(man, addr, true); }
+inline Module* createSHT31(Manager& man, byte addr)            { return new Loom_SHT31(man, addr, true); }
+inline Module* createADS1115(Manager& man, byte addr)          { return new Loom_ADS1115(man, addr, true); }
+inline Module* createK30(Manager& man, byte addr)              { return new Loom_K30(man, true, addr, true); }
+inline Module* createMMA8451(Manager& man, byte addr)          { return new Loom_MMA8451(man, addr, true); }
+inline Module* createDFMultiGasSensor(Manager& man, byte addr) { return new Loom_DFMultiGasSensor(man, addr, 10, false, true); }
+inline Module* createT6793(Manager& man, byte addr)            { return new Loom_T6793(man, addr, 10, true); }
+inline Module* createMPU6050(Manager& man, byte addr)          { return new Loom_MPU6050(man, true); }
+inline Module* createSEN55(Manager& man, byte addr)            { return new Loom_SEN55(man, true, true); }
+inline Module* createMS5803(Manager& man, byte addr)           { return new Loom_MS5803(man, addr, true); }
+inline Module* createSTEMMA(Manager& man, byte addr)           { return new Loom_STEMMA(man, addr, true); }
+inline Module* createMB1232(Manager& man, byte addr)           { return new Loom_MB1232(man, addr, true); }
+
+/* Sensor types that can be handed to the multiplexer */
+constexpr MuxSensorType MUX_TSL2591          = {"TSL2591",           {0x29},         identifyTSL2591,    createTSL2591};
+constexpr MuxSensorType MUX_ZXGESTURE        = {"ZXGesture",         {0x10, 0x11},   nullptr,            createZXGesture};
+constexpr MuxSensorType MUX_SHT31            = {"SHT31",             {0x44, 0x45},   nullptr,            createSHT31};
+constexpr MuxSensorType MUX_ADS1115          = {"ADS1115",           {0x48},         nullptr,            createADS1115};
+constexpr MuxSensorType MUX_K30              = {"K30",               {0x68},         nullptr,            createK30};
+constexpr MuxSensorType MUX_MMA8451          = {"MMA8451",           {0x1C, 0x1D},   identifyMMA8451,    createMMA8451};
+constexpr MuxSensorType MUX_DFMULTIGAS       = {"DFMultiGasSensor",  {0x74, 0x75},   nullptr,            createDFMultiGasSensor};
+constexpr MuxSensorType MUX_T6793            = {"T6793",             {0x15},         nullptr,            createT6793};
+constexpr MuxSensorType MUX_MPU6050          = {"MPU6050",           {0x68},         identifyMPU6050,    createMPU6050};     // The driver only talks to 0x68
+constexpr MuxSensorType MUX_SEN55            = {"SEN55",             {0x69},         identifySEN55,      createSEN55};
+constexpr MuxSensorType MUX_MS5803           = {"MS5803",            {0x76, 0x77},   nullptr,            createMS5803};
+constexpr MuxSensorType MUX_STEMMA           = {"STEMMA",            {0x36},         nullptr,            createSTEMMA};
+constexpr MuxSensorType MUX_MB1232           = {"MB1232",            {0x70},         nullptr,            createMB1232};
+
+/* Every sensor type, used when the multiplexer isn't given its own list */
+constexpr MuxSensorType MUX_ALL_SENSORS[] = {
+    MUX_TSL2591,
+    MUX_ZXGESTURE,
+    MUX_SHT31,
+    MUX_ADS1115,
+    MUX_K30,
+    MUX_MMA8451,
+    MUX_DFMULTIGAS,
+    MUX_T6793,
+    MUX_MPU6050,
+    MUX_SEN55,
+    MUX_MS5803,
+    MUX_STEMMA,
+    MUX_MB1232
+};
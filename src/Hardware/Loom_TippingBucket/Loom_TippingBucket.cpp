@@ -1,9 +1,16 @@
 #include "Loom_TippingBucket.h"
+#include "Logger.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Loom_TippingBucket::Loom_TippingBucket(Manager& man, COUNTER_TYPE type, float inchesPerTip) : Module("TippingBucket"), manInst(&man), inchesPerTip(inchesPerTip) {
+Loom_TippingBucket::Loom_TippingBucket(Manager& man, COUNTER_TYPE type, float inchesPerTip) : Module("TippingBucket"), manInst(&man), inchesPerTip(inchesPerTip), counterType(type) {
     if(type == COUNTER_TYPE::I2C)
         module_address = COUNTER_ADDRESS;
+
+    if(type == COUNTER_TYPE::INTERRUPT){
+        addRollingWindow(300);
+        addRollingWindow(ONE_HOUR_UNIX);
+        addRollingWindow(24 * ONE_HOUR_UNIX);
+    }
     manInst->registerModule(this);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -12,11 +19,22 @@ Loom_TippingBucket::Loom_TippingBucket(Manager& man, COUNTER_TYPE type, float in
 void Loom_TippingBucket::initialize() {
     if(module_address != -1)
         Wire.begin();
+
+    if(counterType == COUNTER_TYPE::INTERRUPT && hypnosInst == nullptr)
+        WARNING(F("Tipping bucket has no Hypnos, time stops while asleep so the rolling windows and max intensity will be wrong!"));
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_TippingBucket::measure() {
+
+    // In interrupt mode every tip already has its own timestamp so the windows only need to be brought up to date
+    if(counterType == COUNTER_TYPE::INTERRUPT){
+        recordTips();
+        expireWindows(getTipTime());
+        return;
+    }
+
     /* First check if we are actually meant to be reading the values from our I2C device, this shouldn't occur if we are using interrupts */
 
     if(module_address != -1){
@@ -70,9 +88,170 @@ void Loom_TippingBucket::package() {
     json["Tips"] = tipCount;
     json["Total_Rainfall(in)"] = tipsToInches(tipCount);
 
-    if(hypnosInst != nullptr)
+    if(counterType == COUNTER_TYPE::INTERRUPT){
+        for(int i = 0; i < windowCount; i++)
+            json[windows[i].fieldName] = tipsToInches(windows[i].tips);
+
+        if(windowCount > 0){
+            json["Max_Intensity(in/hr)"] = getMaxIntensity();
+
+            // Start tracking the next interval from what is currently in the window
+            maxIntensityTips = windows[0].tips;
+        }
+    }
+    else if(hypnosInst != nullptr){
         json["Hourly_Tips"] = hourlyTips;
         json["Hourly_Rainfall(in)"] = tipsToInches(hourlyTips);
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t Loom_TippingBucket::getPackageSize() {
+    if(counterType == COUNTER_TYPE::INTERRUPT)
+        return MODULE_PACKAGE_SIZE(3 + windowCount);
+    return MODULE_PACKAGE_SIZE(4);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_TippingBucket::recordTips() {
+    // Take the tips with interrupts off so one arriving now isn't lost
+    noInterrupts();
+    uint16_t newTips = pendingTips;
+    pendingTips = 0;
+    interrupts();
+
+    if(newTips == 0)
+        return;
+
+    uint32_t now = getTipTime();
+    tipCount += newTips;
+
+    // Each entry holds at most 255 tips
+    while(newTips > 0){
+        uint8_t count = (newTips > UINT8_MAX) ? UINT8_MAX : newTips;
+        addTipEntry(now, count);
+        newTips -= count;
+    }
+
+    expireWindows(now);
+
+    // The first window ending at this tip is the current intensity
+    if(windowCount > 0 && windows[0].tips > maxIntensityTips)
+        maxIntensityTips = windows[0].tips;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_TippingBucket::addTipEntry(uint32_t time, uint8_t count) {
+    uint16_t last = (tipHead + TIP_BUFFER_SIZE - 1) % TIP_BUFFER_SIZE;
+    uint16_t index;
+
+    // Only share an entry every window still holds, otherwise the window would drop tips it never counted
+    bool canShare = tipEntries > 0 && tipTimes[last] == time && tipCounts[last] <= UINT8_MAX - count;
+    for(int i = 0; i < windowCount; i++){
+        if(windows[i].tips == 0)
+            canShare = false;
+    }
+
+    // Tips in the same second share an entry
+    if(canShare){
+        index = last;
+        tipCounts[index] += count;
+    }
+    else{
+        // When the buffer is full the oldest entry is overwritten, any window still holding it has to let it go early
+        if(tipEntries == TIP_BUFFER_SIZE){
+            for(int i = 0; i < windowCount; i++){
+                if(windows[i].tips > 0 && windows[i].start == tipHead){
+                    windows[i].tips -= tipCounts[tipHead];
+                    windows[i].start = (windows[i].start + 1) % TIP_BUFFER_SIZE;
+                }
+            }
+            tipEntries--;
+        }
+
+        index = tipHead;
+        tipTimes[index] = time;
+        tipCounts[index] = count;
+        tipHead = (tipHead + 1) % TIP_BUFFER_SIZE;
+        tipEntries++;
+    }
+
+    for(int i = 0; i < windowCount; i++){
+        if(windows[i].tips == 0)
+            windows[i].start = index;
+        windows[i].tips += count;
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_TippingBucket::expireWindows(uint32_t now) {
+    // Each entry is only ever dropped once per window so this is constant time per tip on average
+    for(int i = 0; i < windowCount; i++){
+        while(windows[i].tips > 0 && tipTimes[windows[i].start] + windows[i].length <= now){
+            windows[i].tips -= tipCounts[windows[i].start];
+            windows[i].start = (windows[i].start + 1) % TIP_BUFFER_SIZE;
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_TippingBucket::addRollingWindow(uint32_t seconds) {
+    if(windowCount >= MAX_ROLLING_WINDOWS || seconds == 0)
+        return false;
+
+    RollingWindow& window = windows[windowCount];
+    window.length = seconds;
+    window.start = tipHead;
+    window.tips = 0;
+
+    // Name the field after the length of the window eg. Rainfall_5min(in)
+    if(seconds % ONE_HOUR_UNIX == 0)
+        snprintf_P(window.fieldName, WINDOW_NAME_SIZE, PSTR("Rainfall_%luh(in)"), (unsigned long)(seconds / ONE_HOUR_UNIX));
+    else if(seconds % 60 == 0)
+        snprintf_P(window.fieldName, WINDOW_NAME_SIZE, PSTR("Rainfall_%lumin(in)"), (unsigned long)(seconds / 60));
+    else
+        snprintf_P(window.fieldName, WINDOW_NAME_SIZE, PSTR("Rainfall_%lus(in)"), (unsigned long)seconds);
+
+    windowCount++;
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+float Loom_TippingBucket::getMaxIntensity() {
+    if(windowCount == 0)
+        return 0;
+    return tipsToInches(maxIntensityTips) * ((float)ONE_HOUR_UNIX / windows[0].length);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint16_t Loom_TippingBucket::getRecentTips(uint32_t* times, uint8_t* counts, uint16_t maxEntries) {
+    uint16_t entries = (tipEntries < maxEntries) ? tipEntries : maxEntries;
+    uint16_t index = (tipHead + TIP_BUFFER_SIZE - entries) % TIP_BUFFER_SIZE;
+
+    for(uint16_t i = 0; i < entries; i++){
+        times[i] = tipTimes[index];
+        counts[i] = tipCounts[index];
+        index = (index + 1) % TIP_BUFFER_SIZE;
+    }
+    return entries;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t Loom_TippingBucket::getTipTime() {
+    // The Hypnos keeps counting while asleep without I2C, so this works from a wake handler with the rails still off
+    if(hypnosInst != nullptr)
+        return hypnosInst->getUnixTime();
+
+    // Without a Hypnos the time only advances while the device is awake
+    return millis() / 1000;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
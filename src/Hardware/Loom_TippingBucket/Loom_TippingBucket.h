@@ -8,9 +8,17 @@
 #define COUNTER_ADDRESS 0x32        // I2C Counter address
 #define ONE_HOUR_UNIX   3600        // Number of seconds in one hour of unix time
 
+/* Interrupt mode */
+#ifndef TIP_BUFFER_SIZE
+    #define TIP_BUFFER_SIZE 256     // Number of tip timestamps kept, tips in the same second share one entry
+#endif
+#define MAX_ROLLING_WINDOWS 4       // Most rolling windows that can be tracked at once
+#define WINDOW_NAME_SIZE 24         // Size of the field name generated for each window
+
 enum COUNTER_TYPE{
     I2C,
-    MANUAL
+    MANUAL,
+    INTERRUPT                       // Each tip is timestamped as it happens, see tipDetected() and recordTips()
 };
 
 /**
@@ -26,12 +34,13 @@ class Loom_TippingBucket : public Module{
         void initialize() override;  
         void package() override;   
         void measure() override;          
+        size_t getPackageSize() override;
     public:
 
         /* Constructor for an I2C based tipping bucket*/
         Loom_TippingBucket(Manager& man, COUNTER_TYPE type, float inchesPerTip = 0.01);
 
-        /* Set an instance of the Hypnos inside the tipping bucket class so we can read RTC data*/
+        /* Set an instance of the Hypnos inside the tipping bucket class so we can read RTC data, required for the rolling windows in interrupt mode as millis() stops while asleep */
         void setHypnosInstance(Loom_Hypnos& hypnos) { this->hypnosInst = &hypnos; };
     
         /* Increase the tip count variable by one */
@@ -42,6 +51,49 @@ class Loom_TippingBucket : public Module{
 
         /* Get the total rainfall over the runtime of the device */
         float getTotalRainfall() {return tipsToInches(tipCount); };
+
+        /* Interrupt Mode */
+
+        /**
+         * Count a tip, safe to call from an ISR
+         * The tip isn't timestamped until recordTips() runs so the ISR doesn't have to talk to the RTC
+         */
+        void tipDetected() { pendingTips++; };
+
+        /**
+         * Timestamp any tips counted by tipDetected() with the current Hypnos time and add them to the rolling windows
+         * Call this from a Hypnos wake handler so tips are recorded without waking the rest of the station, it is also called on every measure
+         * The Hypnos counts the time while asleep without I2C so this is safe before the rails are back on
+         */
+        void recordTips();
+
+        /**
+         * Track the rainfall over another rolling window, the first window added is also used for the max intensity
+         * Interrupt mode starts with 5 minute, 1 hour and 24 hour windows
+         * @param seconds Length of the window
+         */
+        bool addRollingWindow(uint32_t seconds);
+
+        /* Remove all the rolling windows */
+        void clearRollingWindows() { windowCount = 0; };
+
+        /**
+         * Get the rainfall over a rolling window
+         * @param index Index of the window in the order they were added
+         */
+        float getWindowRainfall(uint8_t index) { return (index < windowCount) ? tipsToInches(windows[index].tips) : 0; };
+
+        /* Get the highest rainfall rate in inches per hour seen over the first window since the last package */
+        float getMaxIntensity();
+
+        /**
+         * Copy out the most recent tip timestamps, oldest first
+         * @param times Array to copy the unix time of each entry into
+         * @param counts Array to copy the number of tips in each entry into
+         * @param maxEntries Size of the arrays
+         * @return Number of entries copied
+         */
+        uint16_t getRecentTips(uint32_t* times, uint8_t* counts, uint16_t maxEntries);
     private:
         Manager* manInst = nullptr;                                 // Instance of the manager
         unsigned long tipCount = 0;                                 // The number of tips accumulated by the counter
@@ -54,5 +106,27 @@ class Loom_TippingBucket : public Module{
         std::deque<unsigned long> tips;                      // Track the number of total tips per each sample
         unsigned long lastTipCount = 0;
 
+        /* Interrupt mode tip history */
+        COUNTER_TYPE counterType;                       // How tips are counted
+        volatile uint16_t pendingTips = 0;              // Tips counted by the ISR that haven't been timestamped yet
+        uint32_t tipTimes[TIP_BUFFER_SIZE];             // Ring buffer of tip times in unix time
+        uint8_t tipCounts[TIP_BUFFER_SIZE];             // Number of tips at each time
+        uint16_t tipHead = 0;                           // Index the next entry is written to
+        uint16_t tipEntries = 0;                        // Number of entries in the ring buffer
+
+        struct RollingWindow{
+            uint32_t length;                            // Length of the window in seconds
+            uint16_t start;                             // Index of the oldest entry inside the window
+            unsigned long tips;                         // Number of tips inside the window
+            char fieldName[WINDOW_NAME_SIZE];           // Name the window's rainfall is packaged under
+        };
+        RollingWindow windows[MAX_ROLLING_WINDOWS];
+        uint8_t windowCount = 0;
+        unsigned long maxIntensityTips = 0;             // Most tips seen in the first window since the last package
+
+        void addTipEntry(uint32_t time, uint8_t count); // Add tips to the ring buffer and every window
+        void expireWindows(uint32_t now);               // Drop tips that have aged out of each window
+        uint32_t getTipTime();                          // Current time used to stamp tips
+
         float tipsToInches(unsigned long tips);         // Convert the number of tips of a bucket to inches of rainfall
 };
\ No newline at end of file
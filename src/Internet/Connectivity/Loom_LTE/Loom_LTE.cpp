@@ -7,6 +7,7 @@ Loom_LTE::Loom_LTE(Manager& man, const char* apn, const char* user, const char*
     strncpy(this->gprsUser, user, 100);
     strncpy(this->gprsPass, pass, 100);
     this->powerPin = pin;
+    memset(lastOperator, '\0', 32);
 
     lteBoardVersion = version;
     manInst->registerModule(this);
@@ -15,6 +16,7 @@ Loom_LTE::Loom_LTE(Manager& man, const char* apn, const char* user, const char*
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 Loom_LTE::Loom_LTE(Manager& man) : NetworkComponent("LTE"), manInst(&man), modem(SerialAT), client(modem){
+    memset(lastOperator, '\0', 32);
     manInst->registerModule(this);
 
     // Not initialized because we don't actually know what to connect to yet
@@ -118,9 +120,9 @@ void Loom_LTE::initialize(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_LTE::power_up(){
     FUNCTION_START;
-    // If the batch_sd is initialized and the current batch is one less than the maximum so we turn on the device before the last batch
+    // If the batch_sd is initialized only turn on the device when the batch is going to be published this cycle
     if(batch_sd != nullptr && !firstInit){
-        if(batch_sd->getCurrentBatch() != batch_sd->getBatchSize()-1){
+        if(!batch_sd->shouldPowerUp()){
             powerUp = false;
             FUNCTION_END;
             return;
@@ -131,6 +133,20 @@ void Loom_LTE::power_up(){
 
     // If not connected to a network we want to connect
     if(moduleInitialized){
+        attachStart = millis();
+
+        // A modem that kept its registration only needs waking up
+        if(sessionMode && !firstInit && powered){
+            TIMER_DISABLE;
+            bool resumed = resumeSession();
+            TIMER_ENABLE;
+            if(resumed){
+                FUNCTION_END;
+                return;
+            }
+            WARNING(F("Failed to resume the LTE session, restarting the modem..."));
+        }
+
         LOG(F("Powering up GPRS Modem. This should take about 10 seconds..."));
         TIMER_DISABLE;
 
@@ -139,7 +155,7 @@ void Loom_LTE::power_up(){
 
         // Delay an additional one second to allow communication to open up
         SerialAT.begin(9600);
-        delay(1000);
+        Loom_Executor::getInstance()->wait(1000);
         modem.restart();
         LOG(F("Powering up complete!"));
         powered = true;
@@ -161,6 +177,14 @@ void Loom_LTE::power_up(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_LTE::power_down(){
     FUNCTION_START;
+
+    // Leave the modem on and registered, it goes into PSM by itself once the active time runs out
+    if(sessionMode && moduleInitialized && powerUp && powered){
+        LOG(F("Leaving GPRS Modem registered for the next upload"));
+        FUNCTION_END;
+        return;
+    }
+
     if(moduleInitialized && powerUp){
         LOG(F("Powering down GPRS Modem. This should take about 5 seconds..."));
         modem.poweroff();
@@ -179,7 +203,13 @@ void Loom_LTE::package(){
     FUNCTION_START;
     if(moduleInitialized){
         JsonObject json = manInst->get_data_object(getModuleName());
-        json["RSSI"] = modem.getSignalQuality();
+        int16_t quality = modem.getSignalQuality();
+        json["RSSI"] = quality;
+
+        // Let the upload policy know how good the signal was, 99 means the modem doesn't know
+        if(batch_sd != nullptr && powerUp && quality != 99)
+            batch_sd->recordSignalStrength(-113 + 2 * quality);
+        json["Attach_Time"] = attachTime;
     }
     FUNCTION_END;
 }
@@ -192,6 +222,13 @@ bool Loom_LTE::connect(){
     uint8_t attemptCount = 1; // Tracks number of attempts, 5 is a fail
 
     TIMER_DISABLE;
+
+    // Ask for the last operator we connected through first, the modem falls back to an automatic search if it isn't available
+    if(strlen(lastOperator) > 0){
+        modem.sendAT(GF("+COPS=4,0,\""), lastOperator, GF("\""));
+        modem.waitResponse(10000L);
+    }
+
     do{
         LOG(F("Waiting for network..."));
         if(!modem.waitForNetwork()){
@@ -208,12 +245,25 @@ bool Loom_LTE::connect(){
 
         LOG(F("Connected to network!"));
 
+        // Remember who we registered with so a restart can go straight back to them
+        String op = modem.getOperator();
+        if(op.length() > 0)
+            strncpy(lastOperator, op.c_str(), 31);
+
         // Connect to lte network
         snprintf(output, OUTPUT_SIZE, "Attempting to connect to LTE Network: %s", APN);
         LOG(output);
         if(modem.gprsConnect(APN, gprsUser, gprsPass)){
             LOG(F("Successfully Connected!"));
-            delay(6000);
+            Loom_Executor::getInstance()->wait(6000);
+
+            attachTime = millis() - attachStart;
+            snprintf(output, OUTPUT_SIZE, "Attached in %lu ms", attachTime);
+            LOG(output);
+
+            if(sessionMode)
+                configurePowerSaving();
+
             FUNCTION_END;
             TIMER_ENABLE;
             return true;
@@ -221,7 +271,7 @@ bool Loom_LTE::connect(){
         else{
             snprintf(output, OUTPUT_SIZE, "Connection failed %u / 10. Retrying...", attemptCount);
             WARNING(output);
-            delay(10000);
+            Loom_Executor::getInstance()->wait(10000);
             attemptCount++;
         }
 
@@ -237,6 +287,58 @@ bool Loom_LTE::connect(){
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_LTE::setSessionMode(bool enable, const char* periodicTAU, const char* activeTime, const char* edrx){
+    sessionMode = enable;
+    strncpy(psmTAU, periodicTAU, 9);
+    psmTAU[8] = '\0';
+    strncpy(psmActiveTime, activeTime, 9);
+    psmActiveTime[8] = '\0';
+    memset(edrxCycle, '\0', 5);
+    if(edrx != nullptr)
+        strncpy(edrxCycle, edrx, 4);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_LTE::configurePowerSaving(){
+    // Request PSM with the given timers, the network may grant something different
+    modem.sendAT(GF("+CPSMS=1,,,\""), psmTAU, GF("\",\""), psmActiveTime, GF("\""));
+    if(modem.waitResponse() != 1)
+        WARNING(F("Modem refused the PSM request, the session will be restarted if it is lost"));
+
+    // eDRX on LTE Cat-M1
+    if(strlen(edrxCycle) > 0){
+        modem.sendAT(GF("+CEDRXS=1,4,\""), edrxCycle, GF("\""));
+        if(modem.waitResponse() != 1)
+            WARNING(F("Modem refused the eDRX request"));
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_LTE::resumeSession(){
+    char output[OUTPUT_SIZE];
+    LOG(F("Waking GPRS Modem from PSM..."));
+
+    // The modem only answers once it has come out of PSM
+    if(!modem.testAT(SESSION_WAKE_TIMEOUT))
+        return false;
+
+    // Registration is lost if the network dropped us while we were asleep
+    if(!modem.isNetworkConnected())
+        return false;
+
+    if(!modem.isGprsConnected() && !modem.gprsConnect(APN, gprsUser, gprsPass))
+        return false;
+
+    attachTime = millis() - attachStart;
+    snprintf(output, OUTPUT_SIZE, "Resumed LTE session in %lu ms", attachTime);
+    LOG(output);
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_LTE::disconnect(){
     FUNCTION_START;
@@ -14,6 +14,11 @@
 // Specify what serial interface we want to use
 #define SerialAT Serial1
 
+/* Session Reuse */
+#define SESSION_WAKE_TIMEOUT 5000           // Time in milliseconds to wait for a modem left in PSM to answer before falling back to a full restart
+#define DEFAULT_PSM_TAU "00111000"          // Requested periodic TAU (T3412), 24 hours
+#define DEFAULT_PSM_ACTIVE "00000101"       // Requested active time (T3324), 10 seconds
+
 enum LTE_VERSION{
     SPARKFUN,
     OPENS
@@ -83,6 +88,20 @@ class Loom_LTE : public NetworkComponent{
          */
         void setBatchSD(Loom_BatchSD& batch) { batch_sd = &batch; };
 
+        /**
+         * Keep the modem registered to the network across sleeps instead of powering it off, the modem drops into PSM on its own between uploads
+         * On the next power up the modem is only woken and the data session reopened, if that fails it is restarted like normal
+         * The modem must stay powered while the Hypnos is asleep for this to help
+         * @param enable Whether or not to reuse the session
+         * @param periodicTAU Requested periodic tracking area update timer as a 3GPP T3412 bit string, should be longer than the time between uploads
+         * @param activeTime Requested time the modem stays reachable after each transfer as a 3GPP T3324 bit string
+         * @param edrx Requested eDRX cycle as a 3GPP bit string, nullptr to leave eDRX off
+         */
+        void setSessionMode(bool enable, const char* periodicTAU = DEFAULT_PSM_TAU, const char* activeTime = DEFAULT_PSM_ACTIVE, const char* edrx = nullptr);
+
+        /* Get the time in milliseconds the last power up took to get a data connection */
+        unsigned long getAttachTime() { return attachTime; };
+
         /**
          * Connect to the cellular network
          */
@@ -145,4 +164,16 @@ class Loom_LTE : public NetworkComponent{
 
         bool powered = false;               // Device power status
 
+        /* Session reuse */
+        bool sessionMode = false;           // Keep the modem registered across sleeps
+        char psmTAU[9];                     // Requested periodic TAU bit string
+        char psmActiveTime[9];              // Requested active time bit string
+        char edrxCycle[5];                  // Requested eDRX cycle bit string, empty if not used
+        char lastOperator[32];              // Operator of the last good connection, used to skip the network search after a restart
+        unsigned long attachStart = 0;      // millis() when the last power up started
+        unsigned long attachTime = 0;       // Time in milliseconds the last power up took to connect
+
+        bool resumeSession();               // Wake a modem left in PSM and reopen the data session
+        void configurePowerSaving();        // Request PSM/eDRX from the network
+
 };
\ No newline at end of file
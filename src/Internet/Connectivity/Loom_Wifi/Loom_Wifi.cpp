@@ -4,6 +4,9 @@
 // Reserve a section of memory called WiFi config
 FlashStorage(WiFiConfig, WifiInfo);
 
+// Reserve a section of memory for the last successful connection
+FlashStorage(WiFiLeaseStorage, WifiLease);
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 Loom_WIFI::Loom_WIFI(Manager& man, CommunicationMode mode, const char* name, const char* password, int connectionRetries) : NetworkComponent("WiFi"), manInst(&man), mode(mode), connectionRetries(connectionRetries){
     if(mode == CommunicationMode::AP && strlen(name) <= 0){
@@ -47,7 +50,7 @@ void Loom_WIFI::initialize() {
         power_up();
 
         // Give a bit more time to initialize the module
-        delay(1000);
+        Loom_Executor::getInstance()->wait(1000);
 
 
         // Only try to verify if we have connected to a network
@@ -86,10 +89,16 @@ void Loom_WIFI::package(){
             JsonObject json = manInst->get_data_object(getModuleName());
             json[F("SSID")] = WiFi.SSID();
             json[F("RSSI")] = WiFi.RSSI();
+            json[F("Connect_Time")] = connectTime;
+
+            // Let the upload policy know how good the signal was
+            if(batchSD != nullptr && isConnected())
+                batchSD->recordSignalStrength(WiFi.RSSI());
         }else{
             JsonObject json = manInst->get_data_object(getModuleName());
             json[F("SSID")] = wifi_name;
             json[F("RSSI")] = 0;
+            json[F("Connect_Time")] = 0;
         }
     }
     FUNCTION_END;
@@ -98,9 +107,9 @@ void Loom_WIFI::package(){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_WIFI::power_up() {
-    // If batchSD is defined and our current batch is not equal to one less than the needed for publishing dont power up
+    // If batchSD is defined and the batch isn't going to be published this cycle dont power up
     if(batchSD != nullptr && !firstInit){
-        if(batchSD->getCurrentBatch() != batchSD->getBatchSize()-1){ 
+        if(!batchSD->shouldPowerUp()){ 
             WARNING(F("Not ready to publish, WIFI will not be powered up"));
             powerUp = false;
             return; 
@@ -142,6 +151,17 @@ void Loom_WIFI::connect_to_network(){
     snprintf(output, OUTPUT_SIZE, "Attempting to connect to SSID: %s", wifi_name);
     LOG(output);
     TIMER_DISABLE;
+    unsigned long connectStart = millis();
+
+    // Going straight back to the same access point with the same address skips the DHCP exchange
+    if(fastConnect && connectWithLease()){
+        connectTime = millis() - connectStart;
+        snprintf(output, OUTPUT_SIZE, "Reconnected with cached lease in %lu ms", connectTime);
+        LOG(output);
+        TIMER_ENABLE;
+        FUNCTION_END;
+        return;
+    }
 
     // If we are logging into a network with a password
     if(strlen(wifi_password) > 0){
@@ -150,7 +170,7 @@ void Loom_WIFI::connect_to_network(){
         // While we are trying to connect to the wifi network
         while(WiFi.begin(wifi_name, wifi_password) != WL_CONNECTED){
             LOG(F("Attempting to connect to AP..."));
-            delay(5000);
+            Loom_Executor::getInstance()->wait(5000);
             retry_count++;
 
             // If after 10 attempts we still can't connect to the network we need to stop and break so we don't hang the device
@@ -176,7 +196,7 @@ void Loom_WIFI::connect_to_network(){
         while(WiFi.begin(wifi_name) != WL_CONNECTED){
             snprintf(output, OUTPUT_SIZE, "Attempting to connect to AP (Attempt %i)...", retry_count+1);
             LOG(output);
-            delay(5000);
+            Loom_Executor::getInstance()->wait(5000);
             retry_count++;
 
             // If after 10 attempts we still can't connect to the network we need to stop and break so we don't hang the device
@@ -197,11 +217,77 @@ void Loom_WIFI::connect_to_network(){
         }
     }
 
-    LOG(F("Connected to network!"));
+    connectTime = millis() - connectStart;
+    snprintf(output, OUTPUT_SIZE, "Connected to network in %lu ms", connectTime);
+    LOG(output);
+
+    if(fastConnect)
+        saveLease();
     FUNCTION_END;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_WIFI::connectWithLease(){
+    if(!leaseLoaded){
+        lease = WiFiLeaseStorage.read();
+        leaseLoaded = true;
+    }
+
+    // Only use a lease from this network that is still fresh enough to trust
+    if(!lease.is_valid || strncmp(lease.ssid, wifi_name, 100) != 0 || leaseUses >= MAX_LEASE_REUSES)
+        return false;
+
+    LOG(F("Attempting to reconnect with the cached lease..."));
+    WiFi.config(IPAddress(lease.ip), IPAddress(lease.gateway), IPAddress(lease.gateway), IPAddress(lease.subnet));
+
+    uint8_t status = (strlen(wifi_password) > 0) ? WiFi.begin(wifi_name, wifi_password) : WiFi.begin(wifi_name);
+    if(status == WL_CONNECTED){
+
+        // A different access point may be on a different subnet so the address can't be trusted
+        uint8_t bssid[6];
+        WiFi.BSSID(bssid);
+        if(memcmp(bssid, lease.bssid, 6) == 0){
+            leaseUses++;
+            return true;
+        }
+        WARNING(F("Connected to a different access point than the cached lease, falling back to DHCP"));
+    }
+    else{
+        WARNING(F("Failed to reconnect with the cached lease, falling back to DHCP"));
+    }
+
+    // Restarting the module clears the static address so the normal connect uses DHCP
+    WiFi.disconnect();
+    WiFi.end();
+    leaseUses = MAX_LEASE_REUSES;
+    return false;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_WIFI::saveLease(){
+    WifiLease current;
+    memset(&current, 0, sizeof(WifiLease));
+    current.is_valid = true;
+    strncpy(current.ssid, wifi_name, 100);
+    WiFi.BSSID(current.bssid);
+    current.ip = (uint32_t)WiFi.localIP();
+    current.gateway = (uint32_t)WiFi.gatewayIP();
+    current.subnet = (uint32_t)WiFi.subnetMask();
+    leaseUses = 0;
+
+    // Flash wears out so only write when the lease actually changed
+    if(leaseLoaded && memcmp(&current, &lease, sizeof(WifiLease)) == 0)
+        return;
+
+    lease = current;
+    leaseLoaded = true;
+    WiFiLeaseStorage.write(lease);
+    LOG(F("Cached the WiFi lease to flash"));
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_WIFI::start_ap(){
     FUNCTION_START;
@@ -221,7 +307,8 @@ void Loom_WIFI::start_ap(){
 
     // Wait 10 seconds for the AP to start up
     LOG(F("Waiting for a device to connect to the access point..."));
-    while(WiFi.status() != WL_AP_CONNECTED);
+    while(WiFi.status() != WL_AP_CONNECTED)
+        Loom_Executor::getInstance()->wait(100);
     LOG(F("Device connected to AP!"));
     TIMER_ENABLE;
     FUNCTION_END;
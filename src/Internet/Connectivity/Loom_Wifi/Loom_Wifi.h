@@ -17,6 +17,8 @@ enum CommunicationMode{
     AP              // Set the feather itself as an access point
 };
 
+#define MAX_LEASE_REUSES 24        // Number of times the cached IP lease is reused before going back to DHCP to refresh it
+
 /* WiFi info struct that will be used to store the WiFi data on flash */
 typedef struct {
     bool is_valid;
@@ -24,6 +26,16 @@ typedef struct {
     char password[100];
 } WifiInfo;
 
+/* Last successful connection, stored on flash so a reconnect can skip DHCP */
+typedef struct {
+    bool is_valid;
+    char ssid[100];             // Network the lease belongs to
+    uint8_t bssid[6];           // Access point that handed out the lease
+    uint32_t ip;                // Address we were given
+    uint32_t gateway;           // Gateway of the network, also used as the DNS server
+    uint32_t subnet;            // Subnet mask of the network
+} WifiLease;
+
 /**
  * WiFi 101 library integrated with the manager to allow for easy sleep
  *
@@ -141,6 +153,17 @@ class Loom_WIFI : public NetworkComponent{
         */
         void setMaxRetries(int retries) { connectionRetries = retries; };
 
+        /**
+         * Reconnect using the address from the last successful connection instead of waiting on DHCP, falls back to a normal connect if that doesn't work
+         * Off by default, the address is reused as a static IP for up to MAX_LEASE_REUSES connects whatever the DHCP lease time is and DNS goes to the gateway,
+         * so only enable it on networks where the address is reserved for the device or the lease outlasts that many wake ups
+         * @param enable Whether or not to try the cached lease first
+         */
+        void setFastConnect(bool enable) { fastConnect = enable; };
+
+        /* Get the time in milliseconds the last connection took */
+        unsigned long getConnectTime() { return connectTime; };
+
         /**
          * Convert an IP address to a string
          */
@@ -166,5 +189,15 @@ class Loom_WIFI : public NetworkComponent{
 
         IPAddress remoteIP;                 // IP address to send the UDP requests to
 
+        /* Fast connect */
+        bool fastConnect = false;           // Try the cached lease before DHCP
+        WifiLease lease;                    // Last successful connection
+        bool leaseLoaded = false;           // Whether the lease has been read from flash yet
+        uint8_t leaseUses = 0;              // Number of times the lease has been reused since it was refreshed
+        unsigned long connectTime = 0;      // Time in milliseconds the last connection took
+
+        bool connectWithLease();            // Try to reconnect with the cached lease
+        void saveLease();                   // Cache the current connection
+
 
 };
\ No newline at end of file
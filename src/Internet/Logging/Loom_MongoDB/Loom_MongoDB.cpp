@@ -37,7 +37,6 @@ Loom_MongoDB::Loom_MongoDB(Manager& man, NetworkComponent& internet_client) : MQ
 bool Loom_MongoDB::publish(){
     FUNCTION_START;
     
-    char jsonString[MAX_JSON_SIZE];
     if(moduleInitialized){
 
         TIMER_DISABLE;
@@ -56,8 +55,7 @@ bool Loom_MongoDB::publish(){
         }
 
         /* Attempt to publish the data to the given topic */
-        manInst->getJSONString(jsonString);
-        if(!publishMessage(topic, jsonString)){
+        if(!publishDocument(topic, *manInst)){
             FUNCTION_END;
             return false;
         }
@@ -79,7 +77,6 @@ bool Loom_MongoDB::publishMetadata(char* metadata){
     
     if(moduleInitialized){
 
-        char jsonString[MAX_JSON_SIZE];
         TIMER_DISABLE;
         
         if(strlen(projectServer) > 0)
@@ -118,15 +115,14 @@ bool Loom_MongoDB::publish(Loom_BatchSD& batchSD){
     FUNCTION_START;
     char output[OUTPUT_SIZE];
 
-    if(Loom_Analog::getBatteryVoltage() < 3.4){
+    // With an upload policy the battery is part of the decision made by shouldPublish()
+    if(!batchSD.hasUploadPolicy() && Loom_Analog::getBatteryVoltage() < 3.4){
         WARNING(F("Module not initialized! Battery doesn't have enough power."));
         FUNCTION_END;
         return false;    
     }
     
-    char line[MAX_JSON_SIZE];
-    int packetNumber = 0, index = 0;
-    char c;
+    int packetNumber = 0;
     if(moduleInitialized){
         TIMER_DISABLE;
         if(batchSD.shouldPublish()){
@@ -147,43 +143,44 @@ bool Loom_MongoDB::publish(Loom_BatchSD& batchSD){
 
             bool allDataSuccess = true;
             
-            /* Utilize a stream so it doesn't matter how much data we have as its read in one by one */
+            /* Each line is read once, straight from the file into the manager's document, and published from there so the broker is told its length without reading the line again */
             while(fileOutput.available()){
-                c = fileOutput.read();
 
-                // \r Marks the end of a line, at this point we want to publish that whole packet
-                if(c == '\r'){
+                // The line endings between packets are skipped as whitespace
+                DeserializationError err = deserializeJson(manInst->getDocument(), fileOutput);
+                manInst->clearSerializationCache();
 
-                    // Track the packet number we are currently publishing 
-                    snprintf_P(output, OUTPUT_SIZE, PSTR("Publishing Packet %i of %i"), packetNumber+1, batchSD.getBatchSize());
-                    LOG(output);
+                // A partially written line at the end of the file is skipped
+                if(err == DeserializationError::EmptyInput || err == DeserializationError::IncompleteInput)
+                    break;
 
-                    // Replace the \r with a null character
-                    line[index] = '\0';
+                if(err != DeserializationError::Ok){
+                    snprintf_P(output, OUTPUT_SIZE, PSTR("Error occurred parsing packet #%i of the batch: %s"), packetNumber+1, err.c_str());
+                    ERROR(output);
+                    allDataSuccess = false;
+                    break;
+                }
 
-                    if(!publishMessage(topic, line)){
-                        snprintf(output, OUTPUT_SIZE, PSTR("Failed to publish packet #%i"), packetNumber+1);
-                        WARNING(output);
-                        allDataSuccess = false;
-                    }
+                // Track the packet number we are currently publishing 
+                snprintf_P(output, OUTPUT_SIZE, PSTR("Publishing Packet %i of %i"), packetNumber+1, batchSD.getBatchSize());
+                LOG(output);
 
-                    delay(500);
-                    index = 0;
-                    packetNumber++;
+                if(!publishDocument(topic, *manInst)){
+                    snprintf(output, OUTPUT_SIZE, PSTR("Failed to publish packet #%i"), packetNumber+1);
+                    WARNING(output);
+                    allDataSuccess = false;
                 }
 
-                // If not just add the packet to the line array
-                else{
-                    line[index] = c;
-                    index++;
-                }  
-                
+                delay(500);
+                packetNumber++;
             }
             fileOutput.close();
             
             // Check if we actually sent all the data successfully 
-            if(allDataSuccess)
+            if(allDataSuccess){
                 LOG(F("Data has been successfully sent!")); 
+                batchSD.markPublished();
+            }
             else{
                 WARNING(F("1 or more packets failed to send!"));
                 FUNCTION_END;
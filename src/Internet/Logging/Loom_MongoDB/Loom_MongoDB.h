@@ -25,6 +25,7 @@ class Loom_MongoDB : public MQTTComponent{
         void power_up() override {};
         void power_down() override {}; 
         void package() override {};
+        size_t getPackageSize() override { return 0; };
 
     public: 
 
@@ -71,45 +71,121 @@ bool MQTTComponent::connectToBroker() {
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool MQTTComponent::beginPublish(const char* topic, size_t length, bool retain, int qos){
+    // Make sure the module is initialized
+    if(!moduleInitialized || !internetClient.moduleInitialized){
+        ERROR("Module or NetworkComponent not initialized!");
+        return false;
+    }
+
+    if(!mqttClient.connected()){
+        ERROR("MQTT Client not connected to broker ");
+        return false;
+    }
+
+    // Tell the broker we are still here
+    mqttClient.poll();
+
+    // Start a message of a known size so the client writes straight to the network
+    if(mqttClient.beginMessage(topic, length, retain, qos) != 1){
+        ERROR(F("Failed to begin message!"));
+        return false;
+    }
+
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool MQTTComponent::endPublish(){
+    // Check to see if we are actually closing messages properly
+    if(mqttClient.endMessage() != 1){
+        ERROR(F("Failed to close message!"));
+        return false;
+    }
+
+    LOG(F("Data has been successfully sent!"));
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 bool MQTTComponent::publishMessage(const char* topic, const char* message, bool retain, int qos){
     FUNCTION_START;
 
-    // Make sure the module is initialized
-    if(moduleInitialized && internetClient.moduleInitialized){
-        if(mqttClient.connected()){
-            // Tell the broker we are still here
-            mqttClient.poll();
+    // Message is followed by a line ending
+    if(!beginPublish(topic, strlen(message) + 2, retain, qos)){
+        FUNCTION_END;
+        return false;
+    }
 
-            // Start a message write the data and close the message, publish all messages with retain
-            if(mqttClient.beginMessage(topic, retain, qos) != 1){
-                ERROR(F("Failed to begin message!"));
-            }
+    // Print the message to the topic
+    mqttClient.println(message);
+
+    bool status = endPublish();
+    FUNCTION_END;
+    return status;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
 
-            // Print the message to the topic
-            mqttClient.println(message);
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool MQTTComponent::publishDocument(const char* topic, Manager& manager, bool retain, int qos){
+    FUNCTION_START;
 
-            // Check to see if we are actually closing messages properly
-            if(mqttClient.endMessage() != 1){
-                ERROR(F("Failed to close message!"));
-                FUNCTION_END;
-                return false;
-            }
-            else{
-                LOG(F("Data has been successfully sent!"));
-                FUNCTION_END;
-                return true;
-            }   
-        }
-        else{
-            ERROR("MQTT Client not connected to broker ");
-        }
+    // Document is followed by a line ending to match publishMessage
+    if(!beginPublish(topic, manager.getSerializedLength(FORMAT_JSON) + 2, retain, qos)){
+        FUNCTION_END;
+        return false;
     }
-    else{
-        ERROR("Module or NetworkComponent not initialized!");
+
+    // Serialize directly into the client, no copy of the message is ever held in RAM
+    manager.writeJSON(mqttClient);
+    mqttClient.println();
+
+    bool status = endPublish();
+    FUNCTION_END;
+    return status;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool MQTTComponent::publishStream(const char* topic, Stream& source, size_t length, bool retain, int qos){
+    FUNCTION_START;
+    uint8_t chunk[STREAM_CHUNK_SIZE];
+
+    if(!beginPublish(topic, length + 2, retain, qos)){
+        FUNCTION_END;
+        return false;
+    }
+
+    // Copy the message over a small piece at a time
+    size_t remaining = length;
+    while(remaining > 0){
+        size_t read = source.readBytes(chunk, min(remaining, (size_t)STREAM_CHUNK_SIZE));
+        if(read == 0)
+            break;
+
+        mqttClient.write(chunk, read);
+        remaining -= read;
     }
+
+    // The broker was already told the length, a short message would be read as the start of the next packet so it is padded out and reported as failed
+    bool complete = remaining == 0;
+    if(!complete){
+        WARNINGF("Stream ended %u bytes before the end of the message, the message was padded and won't count as sent", remaining);
+        memset(chunk, ' ', STREAM_CHUNK_SIZE);
+        while(remaining > 0){
+            size_t padding = min(remaining, (size_t)STREAM_CHUNK_SIZE);
+            mqttClient.write(chunk, padding);
+            remaining -= padding;
+        }
+    }
+    mqttClient.println();
+
+    bool status = endPublish() && complete;
     FUNCTION_END;
-    return false;
+    return status;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -3,10 +3,14 @@
 #include <ArduinoMqttClient.h>
 
 #include "Module.h"
+#include "Loom_Manager.h"
 #include "../../Connectivity/NetworkComponent.h"
 
-#define MAX_JSON_SIZE 2000                // The maximum length of an MQTT message
+#ifndef MAX_JSON_SIZE
+    #define MAX_JSON_SIZE 2000                // The maximum length of an MQTT message
+#endif
 #define MAX_TOPIC_LENGTH 512                // The maximum length of a topic string
+#define STREAM_CHUNK_SIZE 64                // Number of bytes copied at a time when streaming a file to the broker
 
 /**
  * MQTT Abstraction class that provides basic MQTT communciation functionality
@@ -32,6 +36,31 @@ class MQTTComponent : public Module{
         */
         bool publishMessage(const char* topic, const char* message, bool retain = false, int qos = 2);
 
+        /**
+         * Publish the manager's current JSON document by streaming it straight into the MQTT client
+         *
+         * @param topic The MQTT topic we want to publish our message to
+         * @param manager Manager holding the document to publish
+         * @param retain Whether or not we want to the message to be retained on the specified topic (default = false)
+         * @param qos What quality-of-service we want to upload the message with (default = 2)
+         *
+         * @return The status of the publish attempt
+        */
+        bool publishDocument(const char* topic, Manager& manager, bool retain = false, int qos = 2);
+
+        /**
+         * Publish a fixed number of bytes read from a stream (eg. a line of a batch file) without buffering the whole message
+         *
+         * @param topic The MQTT topic we want to publish our message to
+         * @param source Stream to read the message from
+         * @param length Number of bytes of the stream that make up the message
+         * @param retain Whether or not we want to the message to be retained on the specified topic (default = false)
+         * @param qos What quality-of-service we want to upload the message with (default = 2)
+         *
+         * @return The status of the publish attempt, false if the stream ended early and the message had to be padded with spaces to the announced length
+        */
+        bool publishStream(const char* topic, Stream& source, size_t length, bool retain = false, int qos = 2);
+
         /**
          * Subscribe to a given topic to get the retained message and then immediately unsubscribe
          *
@@ -115,6 +144,18 @@ class MQTTComponent : public Module{
         void setMaxRetries(int retries) { maxRetries = retries; };
 
     private:
+
+        /**
+         * Check the connection and start a message of a known length, knowing the length lets the client stream the payload instead of buffering it
+         * @return Whether or not the message was started
+         */
+        bool beginPublish(const char* topic, size_t length, bool retain, int qos);
+
+        /**
+         * Close the current message and check that it was sent
+         */
+        bool endPublish();
+
         MqttClient mqttClient;                      // Instance of the MQTT client
         NetworkComponent& internetClient;
 
@@ -0,0 +1,56 @@
+#include "Loom_Arena.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+Loom_Arena* Loom_Arena::getInstance(){
+    // Function level static so the pool is only linked in when something actually uses the arena
+    static Loom_Arena instance;
+    return &instance;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void* Loom_Arena::allocate(size_t size){
+#if defined(MANAGER_ARENA_ENABLE)
+    // Round up so the next block stays aligned
+    size_t alignedSize = (size + (ARENA_ALIGNMENT - 1)) & ~((size_t)ARENA_ALIGNMENT - 1);
+
+    if(used + alignedSize <= ARENA_SIZE){
+        void* block = &pool[used];
+        used += alignedSize;
+        return block;
+    }
+
+    // The arena is full, count it so it can be reported and hand back heap memory so the caller still works
+    failedAllocations++;
+#endif
+    return malloc(size);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+char* Loom_Arena::allocateString(size_t length){
+    char* str = (char*)allocate(length);
+    if(str != nullptr)
+        memset(str, '\0', length);
+    return str;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+char* Loom_Arena::copyString(const char* str){
+    char* copy = allocateString(strlen(str) + 1);
+    if(copy != nullptr)
+        strcpy(copy, str);
+    return copy;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t Loom_Arena::getCapacity(){
+#if defined(MANAGER_ARENA_ENABLE)
+    return ARENA_SIZE;
+#else
+    return 0;
+#endif
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Arduino.h"
+#include <ArduinoJson.h>
+#include <new>
+
+#include "Module.h"
+
+/* Arena Setup */
+// When MANAGER_ARENA_ENABLE is set the Manager document and all long-lived module strings are placed in one static pool instead of the heap
+#define ARENA_SERIAL_BUFFERS 3      // JSON, MessagePack and CSV serialization buffers the Manager keeps next to the document
+#define ARENA_STRING_SIZE 1024      // Room left for module names, labels and other long-lived strings
+
+// The document, a JSON_TEXT_SIZE buffer for each serialization format and the strings, a packet received over a radio replaces the local data so one MAX_JSON_SIZE document covers it
+#ifndef ARENA_SIZE
+    #define ARENA_SIZE (MAX_JSON_SIZE + ARENA_SERIAL_BUFFERS * JSON_TEXT_SIZE(MAX_JSON_SIZE) + ARENA_STRING_SIZE)
+#endif
+
+#define ARENA_ALIGNMENT 4      // Every block handed out is aligned to a word boundary
+
+/**
+ * Fixed size memory pool used for allocations that live for the entire runtime of the device (JSON document, sensor names, labels)
+ * Memory is handed out linearly and never freed, so the heap doesn't fragment over weeks of deployment
+ *
+ * If MANAGER_ARENA_ENABLE is not defined all allocations are passed directly to the heap
+ */
+class Loom_Arena{
+    public:
+        // Deleting copy constructor.
+        Loom_Arena(const Loom_Arena &obj) = delete;
+
+        /* Get an instance of the arena */
+        static Loom_Arena* getInstance();
+
+        /**
+         * Allocate a block of memory that is never freed
+         * If the arena is full the allocation falls back to the heap and the failure is counted
+         * @param size Number of bytes to allocate
+         */
+        void* allocate(size_t size);
+
+        /**
+         * Allocate a zeroed character buffer for a string that lives as long as the module does
+         * @param length Size of the buffer including the null terminator
+         */
+        char* allocateString(size_t length);
+
+        /**
+         * Copy a string into the arena
+         * @param str String to copy
+         */
+        char* copyString(const char* str);
+
+        /* Number of bytes currently used in the arena */
+        size_t getUsed() { return used; };
+
+        /* Total number of bytes the arena can hold, 0 if the arena is disabled */
+        size_t getCapacity();
+
+        /* Number of allocations that did not fit in the arena */
+        uint32_t getFailedAllocations() { return failedAllocations; };
+
+    private:
+        Loom_Arena() {};
+
+        size_t used = 0;                                        // Number of bytes handed out so far
+        uint32_t failedAllocations = 0;                         // Allocations that had to fall back to the heap
+
+#if defined(MANAGER_ARENA_ENABLE)
+        alignas(ARENA_ALIGNMENT) uint8_t pool[ARENA_SIZE];      // Statically allocated memory pool
+#endif
+};
+
+/**
+ * JSON document whose memory pool is carved out of the Loom arena instead of the heap
+ */
+class ArenaJsonDocument : public JsonDocument{
+    public:
+        /**
+         * Construct a new document in the arena
+         * @param capacity Size in bytes of the memory pool used by the document
+         */
+        ArenaJsonDocument(size_t capacity) : JsonDocument((char*)Loom_Arena::getInstance()->allocate(capacity), capacity) {};
+
+        /**
+         * Move the document to a new pool from the arena, only call while the document is empty as the old pool is never given back
+         * @param capacity Size in bytes of the new pool
+         */
+        void reserve(size_t capacity) { this->~ArenaJsonDocument(); new (this) ArenaJsonDocument(capacity); };
+
+        // The pool is owned by the arena so the document must never be copied
+        ArenaJsonDocument(const ArenaJsonDocument &obj) = delete;
+};
@@ -0,0 +1,52 @@
+#include "Loom_DMA.h"
+
+// Descriptors for the DMA controller, only used if nothing else has set it up already
+static __attribute__((aligned(16))) DmacDescriptor dmaDescriptors[DMAC_CH_NUM];
+static __attribute__((aligned(16))) DmacDescriptor dmaWriteback[DMAC_CH_NUM];
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+DmacDescriptor* Loom_DMA::getDescriptor(uint8_t channel){
+
+    // Set up the DMA controller if nothing else has, otherwise share its descriptor table
+    PM->AHBMASK.reg |= PM_AHBMASK_DMAC;
+    PM->APBBMASK.reg |= PM_APBBMASK_DMAC;
+    if(!DMAC->CTRL.bit.DMAENABLE){
+        DMAC->BASEADDR.reg = (uint32_t)dmaDescriptors;
+        DMAC->WRBADDR.reg = (uint32_t)dmaWriteback;
+        DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+    }
+
+    return &((DmacDescriptor*)DMAC->BASEADDR.reg)[channel];
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_DMA::configureChannel(uint8_t channel, uint8_t trigger){
+    DMAC->CHID.reg = channel;
+    DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+    DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(trigger) | DMAC_CHCTRLB_TRIGACT_BEAT;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_DMA::startChannel(uint8_t channel){
+    DMAC->CHID.reg = channel;
+    DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_MASK;
+    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_DMA::stopChannel(uint8_t channel){
+    DMAC->CHID.reg = channel;
+    DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_DMA::isComplete(uint8_t channel){
+    DMAC->CHID.reg = channel;
+    return DMAC->CHINTFLAG.bit.TCMPL;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
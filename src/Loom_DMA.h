@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Arduino.h"
+
+/**
+ * Shared access to the SAMD21 DMA controller
+ * Everything that moves data with DMA (ADC scans, I2C transfers) shares one descriptor table so it is only allocated once, if a library has already set the controller up its table is used instead
+ */
+class Loom_DMA{
+    public:
+        /**
+         * Enable the DMA controller if nothing has yet and get the descriptor for the given channel
+         * @param channel DMA channel to use
+         */
+        static DmacDescriptor* getDescriptor(uint8_t channel);
+
+        /**
+         * Reset the channel and point it at a new trigger, fill in the descriptor afterwards and call startChannel
+         * @param channel DMA channel to configure
+         * @param trigger Peripheral trigger that moves each beat, e.g. ADC_DMAC_ID_RESRDY
+         */
+        static void configureChannel(uint8_t channel, uint8_t trigger);
+
+        /**
+         * Clear the flags and enable the channel, the transfer starts on the next trigger
+         * @param channel DMA channel to start
+         */
+        static void startChannel(uint8_t channel);
+
+        /**
+         * Disable the channel, stops a transfer that is still running
+         * @param channel DMA channel to stop
+         */
+        static void stopChannel(uint8_t channel);
+
+        /**
+         * Whether the last transfer on the channel has finished
+         * @param channel DMA channel to check
+         */
+        static bool isComplete(uint8_t channel);
+};
@@ -0,0 +1,114 @@
+#include "Loom_Executor.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+Loom_Executor* Loom_Executor::getInstance(){
+    static Loom_Executor instance;
+    return &instance;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+int Loom_Executor::addTask(TaskFunction task, void* context, uint32_t delayMs){
+    if(task == nullptr)
+        return -1;
+
+    for(int i = 0; i < MAX_TASKS; i++){
+        if(tasks[i].function == nullptr){
+            tasks[i].function = task;
+            tasks[i].context = context;
+            tasks[i].runAt = millis() + delayMs;
+            tasks[i].generation = (tasks[i].generation + 1) & 0x7FFF;
+            return i | (tasks[i].generation << TASK_SLOT_BITS);
+        }
+    }
+    return -1;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Executor::cancelTask(int id){
+    Task* task = findTask(id);
+    if(task != nullptr)
+        freeTask(*task);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_Executor::isTaskPending(int id){
+    return findTask(id) != nullptr;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+Loom_Executor::Task* Loom_Executor::findTask(int id){
+    if(id < 0)
+        return nullptr;
+
+    int slot = id & TASK_SLOT_MASK;
+    if(slot >= MAX_TASKS || tasks[slot].function == nullptr || tasks[slot].generation != (id >> TASK_SLOT_BITS))
+        return nullptr;
+
+    return &tasks[slot];
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Executor::freeTask(Task& task){
+    task.function = nullptr;
+    task.context = nullptr;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint8_t Loom_Executor::runPending(){
+    uint8_t count = 0;
+
+    // A task that calls wait() just waits, it doesn't get to run the other tasks
+    if(running)
+        return 0;
+
+    running = true;
+    for(int i = 0; i < MAX_TASKS; i++){
+        if(tasks[i].function == nullptr || (long)(millis() - tasks[i].runAt) < 0)
+            continue;
+
+        uint32_t next = tasks[i].function(tasks[i].context);
+        count++;
+
+        // The task may have been cancelled while it was running
+        if(tasks[i].function == nullptr)
+            continue;
+
+        if(next == TASK_COMPLETE)
+            freeTask(tasks[i]);
+        else
+            tasks[i].runAt = millis() + next;
+    }
+    running = false;
+
+    return count;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Executor::wait(uint32_t ms){
+    unsigned long startTime = millis();
+    while(millis() - startTime < ms){
+        runPending();
+        yield();
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_Executor::waitFor(bool (*condition)(void*), void* context, uint32_t timeoutMs){
+    unsigned long startTime = millis();
+    while(!condition(context)){
+        if(millis() - startTime >= timeoutMs)
+            return false;
+        runPending();
+        yield();
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
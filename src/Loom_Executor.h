@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Arduino.h"
+
+/* Executor Setup */
+#ifndef MAX_TASKS
+    #define MAX_TASKS 8                 // Most tasks that can be scheduled at once
+#endif
+
+#define TASK_COMPLETE 0xFFFFFFFF        // Returned by a task once it has nothing left to do
+
+#define TASK_SLOT_BITS 8                // Low bits of a task ID hold the slot, the rest hold the slot's generation so old IDs don't match a reused slot
+#define TASK_SLOT_MASK ((1 << TASK_SLOT_BITS) - 1)
+
+/**
+ * A resumable task, does one small piece of work each time it is called and must not block
+ * @param context Pointer given when the task was scheduled, usually the module that owns the task
+ * @return Milliseconds until the task wants to run again, or TASK_COMPLETE to remove it
+ */
+using TaskFunction = uint32_t (*)(void* context);
+
+/**
+ * Tiny cooperative executor that lets long waits (radio attach, power rail settling, slow serial sensors) run other work instead of spinning in delay()
+ * Tasks are only ever run from inside wait() or runPending() so they never interrupt the code that scheduled them
+ * Work currently handed to it: the SD card trimming a full batch backlog and queued I2C transactions, anything else that waits just runs them
+ */
+class Loom_Executor{
+    public:
+        // Deleting copy constructor.
+        Loom_Executor(const Loom_Executor &obj) = delete;
+
+        /* Get an instance of the executor */
+        static Loom_Executor* getInstance();
+
+        /**
+         * Schedule a task to be run the next time something waits
+         * @param task Function to call
+         * @param context Pointer passed back to the task every time it is run
+         * @param delayMs Milliseconds before the task is first run
+         * @return ID of the task, -1 if there was no room for it
+         */
+        int addTask(TaskFunction task, void* context = nullptr, uint32_t delayMs = 0);
+
+        /**
+         * Remove a task before it completes, does nothing if the task has already finished
+         * @param id ID returned by addTask
+         */
+        void cancelTask(int id);
+
+        /**
+         * Whether or not the task is still scheduled, IDs of finished tasks never match a task that later reuses their slot
+         * @param id ID returned by addTask
+         */
+        bool isTaskPending(int id);
+
+        /**
+         * Run every task that is currently due once
+         * @return Number of tasks that were run
+         */
+        uint8_t runPending();
+
+        /**
+         * Cooperative replacement for delay(), runs due tasks until the given time has passed
+         * @param ms Milliseconds to wait for
+         */
+        void wait(uint32_t ms);
+
+        /**
+         * Wait until the condition is true, running due tasks in the meantime
+         * @param condition Function checked between tasks
+         * @param context Pointer passed to the condition
+         * @param timeoutMs Longest time to wait
+         * @return Whether the condition became true before the timeout
+         */
+        bool waitFor(bool (*condition)(void*), void* context, uint32_t timeoutMs);
+
+    private:
+        Loom_Executor() {};
+
+        /**
+         * Scheduled task
+         */
+        struct Task{
+            TaskFunction function = nullptr;    // Function to call, null if the slot is free
+            void* context = nullptr;            // Passed to the function
+            unsigned long runAt = 0;            // millis() time the task is next due
+            uint16_t generation = 0;            // Incremented every time the slot is reused, part of the task ID
+        };
+
+        Task tasks[MAX_TASKS];                  // Task slots
+        bool running = false;                   // Set while a task is running so a task that waits doesn't run other tasks inside itself
+
+        Task* findTask(int id);                 // Slot the ID refers to, null if that task is no longer scheduled
+        void freeTask(Task& task);              // Clear a slot so it can be reused
+};
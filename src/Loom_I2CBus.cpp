@@ -0,0 +1,377 @@
+#include "Loom_I2CBus.h"
+#include "Loom_Executor.h"
+#include "Logger.h"
+
+#if defined(ARDUINO_ARCH_SAMD)
+    #include "Loom_DMA.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CWire::start(I2CTransaction& transaction){
+
+    // Anything to write, a transaction with nothing to write or read is just checking the device is there
+    if(transaction.writeLength > 0 || transaction.readLength == 0){
+        Wire.beginTransmission(transaction.address);
+        if(transaction.writeLength > 0)
+            Wire.write(transaction.writeData, transaction.writeLength);
+
+        // Hold on to the bus with a repeated start if a read follows
+        uint8_t result = Wire.endTransmission(transaction.readLength == 0);
+        if(result != 0){
+            transaction.status = (result == 2 || result == 3) ? I2C_STATUS::NACK : I2C_STATUS::BUS_ERROR;
+            return;
+        }
+    }
+
+    // Wire has already clocked every byte in by the time requestFrom returns, copy them out in one go
+    if(transaction.readLength > 0){
+        if(Wire.requestFrom(transaction.address, (size_t)transaction.readLength) < transaction.readLength){
+            transaction.status = I2C_STATUS::NACK;
+            return;
+        }
+        Wire.readBytes(transaction.readData, transaction.readLength);
+    }
+
+    transaction.status = I2C_STATUS::DONE;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(ARDUINO_ARCH_SAMD)
+// Wait for a write to the SERCOM's command bits to take effect
+static void syncBus(){
+    while(I2C_SERCOM->I2CM.SYNCBUSY.bit.SYSOP);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CDMA::start(I2CTransaction& transaction){
+
+    // DMA needs at least one byte so probes go through Wire
+    if(transaction.writeLength == 0 && transaction.readLength == 0){
+        wire.start(transaction);
+        phase = Phase::IDLE;
+        return;
+    }
+
+    // Clear anything left over from the last transfer, smart mode lets the DMA reads acknowledge each byte
+    I2C_SERCOM->I2CM.STATUS.reg = SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST | SERCOM_I2CM_STATUS_LENERR;
+    syncBus();
+    I2C_SERCOM->I2CM.CTRLB.bit.SMEN = 1;
+    syncBus();
+
+    if(transaction.writeLength > 0)
+        startWrite(transaction);
+    else
+        startRead(transaction);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CDMA::startWrite(I2CTransaction& transaction){
+    DmacDescriptor* descriptor = Loom_DMA::getDescriptor(I2C_DMA_CHANNEL);
+    Loom_DMA::configureChannel(I2C_DMA_CHANNEL, I2C_DMAC_ID_TX);
+    descriptor->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC | DMAC_BTCTRL_BLOCKACT_NOACT;
+    descriptor->BTCNT.reg = transaction.writeLength;
+    descriptor->SRCADDR.reg = (uint32_t)(transaction.writeData + transaction.writeLength);    // The end address when incrementing
+    descriptor->DSTADDR.reg = (uint32_t)&I2C_SERCOM->I2CM.DATA.reg;
+    descriptor->DESCADDR.reg = 0;
+    Loom_DMA::startChannel(I2C_DMA_CHANNEL);
+
+    // Writing the address sends the start condition, the SERCOM then asks the DMA for each byte
+    phase = Phase::WRITE;
+    I2C_SERCOM->I2CM.ADDR.reg = SERCOM_I2CM_ADDR_ADDR(transaction.address << 1) | SERCOM_I2CM_ADDR_LENEN | SERCOM_I2CM_ADDR_LEN(transaction.writeLength);
+    syncBus();
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CDMA::startRead(I2CTransaction& transaction){
+    DmacDescriptor* descriptor = Loom_DMA::getDescriptor(I2C_DMA_CHANNEL);
+    Loom_DMA::configureChannel(I2C_DMA_CHANNEL, I2C_DMAC_ID_RX);
+    descriptor->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_DSTINC | DMAC_BTCTRL_BLOCKACT_NOACT;
+    descriptor->BTCNT.reg = transaction.readLength;
+    descriptor->SRCADDR.reg = (uint32_t)&I2C_SERCOM->I2CM.DATA.reg;
+    descriptor->DSTADDR.reg = (uint32_t)(transaction.readData + transaction.readLength);     // The end address when incrementing
+    descriptor->DESCADDR.reg = 0;
+    Loom_DMA::startChannel(I2C_DMA_CHANNEL);
+
+    // Acknowledge every byte, the SERCOM NACKs the last one itself because it knows the length
+    phase = Phase::READ;
+    I2C_SERCOM->I2CM.CTRLB.bit.ACKACT = 0;
+    syncBus();
+    I2C_SERCOM->I2CM.ADDR.reg = SERCOM_I2CM_ADDR_ADDR((transaction.address << 1) | 1) | SERCOM_I2CM_ADDR_LENEN | SERCOM_I2CM_ADDR_LEN(transaction.readLength);
+    syncBus();
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_I2CDMA::poll(I2CTransaction& transaction){
+    if(phase == Phase::IDLE)
+        return true;
+
+    SercomI2cm& bus = I2C_SERCOM->I2CM;
+
+    if(bus.STATUS.bit.BUSERR || bus.STATUS.bit.ARBLOST){
+        finishTransfer(transaction, I2C_STATUS::BUS_ERROR);
+        return true;
+    }
+
+    // The device didn't acknowledge its address or one of the bytes we sent
+    if(bus.INTFLAG.bit.MB && bus.STATUS.bit.RXNACK){
+        finishTransfer(transaction, I2C_STATUS::NACK);
+        return true;
+    }
+
+    if(!Loom_DMA::isComplete(I2C_DMA_CHANNEL))
+        return false;
+
+    if(phase == Phase::WRITE){
+
+        // The DMA finishes as soon as the last byte is in the data register, wait for it to actually go out
+        if(!bus.INTFLAG.bit.MB && bus.STATUS.bit.BUSSTATE != 0x1)
+            return false;
+
+        // Repeated start straight into the read
+        if(transaction.readLength > 0){
+            startRead(transaction);
+            return false;
+        }
+    }
+
+    finishTransfer(transaction, I2C_STATUS::DONE);
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CDMA::abort(I2CTransaction& transaction){
+    if(phase != Phase::IDLE)
+        finishTransfer(transaction, I2C_STATUS::TIMEOUT);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CDMA::finishTransfer(I2CTransaction& transaction, I2C_STATUS status){
+    Loom_DMA::stopChannel(I2C_DMA_CHANNEL);
+
+    // Send the stop ourselves if the SERCOM is still holding the bus
+    if(I2C_SERCOM->I2CM.STATUS.bit.BUSSTATE == 0x2){
+        I2C_SERCOM->I2CM.CTRLB.reg |= SERCOM_I2CM_CTRLB_ACKACT | SERCOM_I2CM_CTRLB_CMD(3);
+        syncBus();
+    }
+
+    // Wire expects smart mode to be off
+    I2C_SERCOM->I2CM.CTRLB.bit.SMEN = 0;
+    syncBus();
+
+    transaction.status = status;
+    phase = Phase::IDLE;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+Loom_I2CBus* Loom_I2CBus::getInstance(){
+    static Loom_I2CBus instance;
+    return &instance;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CBus::setBackend(I2CBackend* backend){
+
+    // Let whatever is on the bus finish on the backend that started it
+    while(process());
+    this->backend = (backend != nullptr) ? backend : &wireBackend;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CBus::enableDMA(bool enable){
+#if defined(ARDUINO_ARCH_SAMD)
+    setBackend(enable ? (I2CBackend*)&dmaBackend : &wireBackend);
+#else
+    if(enable)
+        WARNING(F("DMA transfers are only supported on the SAMD21, using Wire"));
+#endif
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_I2CBus::submit(I2CTransaction& transaction){
+    if(queueLength >= MAX_I2C_TRANSACTIONS){
+        WARNING(F("I2C queue is full, transaction dropped"));
+        transaction.status = I2C_STATUS::BUS_ERROR;
+        return false;
+    }
+
+    transaction.status = I2C_STATUS::QUEUED;
+    transaction.submitTime = micros();
+    queue[queueLength++] = &transaction;
+
+    // Keep the queue moving whenever something waits
+    if(taskID == -1)
+        taskID = Loom_Executor::getInstance()->addTask(processTask, this);
+
+    process();
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_I2CBus::process(){
+    while(queueLength > 0){
+        I2CTransaction& current = *queue[0];
+
+        if(current.status == I2C_STATUS::QUEUED){
+            current.status = I2C_STATUS::ACTIVE;
+            current.startTime = micros();
+            backend->start(current);
+        }
+
+        if(!backend->poll(current)){
+            if(micros() - current.startTime < I2C_TRANSACTION_TIMEOUT * 1000UL)
+                return true;
+
+            backend->abort(current);
+            current.status = I2C_STATUS::TIMEOUT;
+        }
+
+        finish(0);
+    }
+    return false;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_I2CBus::wait(I2CTransaction& transaction, uint32_t timeoutMs){
+
+    // Take it out of the queue so the bus never touches memory the caller is about to release
+    if(!Loom_Executor::getInstance()->waitFor(isFinished, &transaction, timeoutMs))
+        remove(transaction);
+
+    return transaction.status == I2C_STATUS::DONE;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_I2CBus::cancel(I2CTransaction& transaction){
+    transaction.onComplete = nullptr;
+    return remove(transaction);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_I2CBus::transfer(uint8_t address, const uint8_t* writeData, uint8_t writeLength, uint8_t* readData, uint8_t readLength){
+    I2CTransaction transaction;
+    transaction.address = address;
+    transaction.writeData = writeData;
+    transaction.writeLength = writeLength;
+    transaction.readData = readData;
+    transaction.readLength = readLength;
+
+    if(!submit(transaction))
+        return false;
+
+    return wait(transaction);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+const I2CDeviceStats* Loom_I2CBus::getStats(uint8_t address){
+    for(int i = 0; i < deviceCount; i++){
+        if(stats[i].address == address)
+            return &stats[i];
+    }
+    return nullptr;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CBus::printStats(){
+    for(int i = 0; i < deviceCount; i++){
+        LOGF("I2C 0x%02X: %lu transactions, %lu failed, %lu us average, %lu us max", stats[i].address, (unsigned long)stats[i].transactions, (unsigned long)stats[i].failures, (unsigned long)stats[i].averageMicros(), (unsigned long)stats[i].maxMicros);
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CBus::finish(uint8_t index){
+    I2CTransaction& transaction = *queue[index];
+    record(transaction);
+
+    for(int i = index; i < queueLength - 1; i++)
+        queue[i] = queue[i + 1];
+    queueLength--;
+
+    // Out of the queue first so the callback is free to submit again
+    if(transaction.onComplete != nullptr)
+        transaction.onComplete(transaction, transaction.context);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_I2CBus::remove(I2CTransaction& transaction){
+    for(int i = 0; i < queueLength; i++){
+        if(queue[i] == &transaction){
+            if(transaction.status == I2C_STATUS::ACTIVE)
+                backend->abort(transaction);
+            transaction.status = I2C_STATUS::TIMEOUT;
+            finish(i);
+            return true;
+        }
+    }
+    return false;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CBus::record(const I2CTransaction& transaction){
+    I2CDeviceStats* entry = nullptr;
+
+    for(int i = 0; i < deviceCount; i++){
+        if(stats[i].address == transaction.address){
+            entry = &stats[i];
+            break;
+        }
+    }
+
+    // Devices past the end of the table just aren't tracked
+    if(entry == nullptr){
+        if(deviceCount >= MAX_I2C_DEVICES)
+            return;
+        entry = &stats[deviceCount++];
+        *entry = I2CDeviceStats();
+        entry->address = transaction.address;
+    }
+
+    uint32_t elapsed = micros() - transaction.submitTime;
+    entry->transactions++;
+    entry->totalMicros += elapsed;
+    entry->maxMicros = max(entry->maxMicros, elapsed);
+    if(transaction.status != I2C_STATUS::DONE)
+        entry->failures++;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t Loom_I2CBus::processTask(void* context){
+    Loom_I2CBus* bus = (Loom_I2CBus*)context;
+    if(bus->process())
+        return 0;
+
+    // The executor frees the slot, submit() schedules a new task next time
+    bus->taskID = -1;
+    return TASK_COMPLETE;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_I2CBus::isFinished(void* context){
+    I2C_STATUS status = ((I2CTransaction*)context)->status;
+    if(status == I2C_STATUS::QUEUED || status == I2C_STATUS::ACTIVE){
+        Loom_I2CBus::getInstance()->process();
+        status = ((I2CTransaction*)context)->status;
+    }
+    return status != I2C_STATUS::QUEUED && status != I2C_STATUS::ACTIVE;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
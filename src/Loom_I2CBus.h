@@ -0,0 +1,259 @@
+#pragma once
+
+#include "Arduino.h"
+#include <Wire.h>
+
+/* Bus Setup */
+#ifndef MAX_I2C_TRANSACTIONS
+    #define MAX_I2C_TRANSACTIONS 8          // Most transactions that can be queued at once
+#endif
+
+#ifndef MAX_I2C_DEVICES
+    #define MAX_I2C_DEVICES 16              // Most device addresses latency is tracked for
+#endif
+
+#define I2C_TRANSACTION_TIMEOUT 100         // Milliseconds a transaction gets on the bus before it is abandoned
+
+#ifndef I2C_DMA_CHANNEL
+    #define I2C_DMA_CHANNEL 10              // DMA channel used for I2C transfers, one below the analog scan's
+#endif
+
+// SERCOM the Wire instance is on, SERCOM3 on the Feather M0
+#ifndef I2C_SERCOM
+    #define I2C_SERCOM SERCOM3
+    #define I2C_DMAC_ID_TX SERCOM3_DMAC_ID_TX
+    #define I2C_DMAC_ID_RX SERCOM3_DMAC_ID_RX
+#endif
+
+/**
+ * Where a transaction is at
+ */
+enum class I2C_STATUS{
+    QUEUED,                                 // Waiting for the bus
+    ACTIVE,                                 // On the bus
+    DONE,                                   // Finished successfully
+    NACK,                                   // The device didn't acknowledge its address or the data
+    TIMEOUT,                                // Took longer than I2C_TRANSACTION_TIMEOUT
+    BUS_ERROR                               // Lost arbitration or the bus misbehaved
+};
+
+/**
+ * One I2C transfer, an optional write followed by an optional read with a repeated start in between
+ * The transaction is referenced by the bus until it finishes so it must stay in scope until then, or until it is cancelled
+ */
+struct I2CTransaction{
+    uint8_t address = 0;                    // 7 bit address of the device
+    const uint8_t* writeData = nullptr;     // Bytes to send first
+    uint8_t writeLength = 0;                // Number of bytes to send
+    uint8_t* readData = nullptr;            // Where to put the bytes read back
+    uint8_t readLength = 0;                 // Number of bytes to read
+    volatile I2C_STATUS status = I2C_STATUS::DONE;
+    unsigned long submitTime = 0;           // Micros when the transaction was queued
+    unsigned long startTime = 0;            // Micros when the transaction went on the bus
+
+    void (*onComplete)(I2CTransaction& transaction, void* context) = nullptr;     // Called once the transaction has left the queue, whatever its status, must not block
+    void* context = nullptr;                // Passed to onComplete
+};
+
+/**
+ * Latency counters for one device
+ */
+struct I2CDeviceStats{
+    uint8_t address = 0;                    // 7 bit address of the device
+    uint32_t transactions = 0;              // Transactions that finished, including failures
+    uint32_t failures = 0;                  // Transactions that didn't finish successfully
+    uint32_t totalMicros = 0;               // Time from being queued to finishing, summed over every transaction
+    uint32_t maxMicros = 0;                 // Longest time from being queued to finishing
+
+    /* Average time from being queued to finishing */
+    uint32_t averageMicros() const { return (transactions > 0) ? totalMicros / transactions : 0; };
+};
+
+/**
+ * Moves a transaction over the bus, implement this to swap how the bytes actually get there
+ */
+class I2CBackend{
+    public:
+        virtual ~I2CBackend() {};
+
+        /**
+         * Put the transaction on the bus
+         * @param transaction Transaction to start
+         */
+        virtual void start(I2CTransaction& transaction) = 0;
+
+        /**
+         * Advance the transaction, must not block
+         * @param transaction Transaction that was started
+         * @return Whether the transaction has finished, the status is set once it has
+         */
+        virtual bool poll(I2CTransaction& transaction) = 0;
+
+        /**
+         * Give up on a transaction that has taken too long and free the bus
+         * @param transaction Transaction that was started
+         */
+        virtual void abort(I2CTransaction& transaction) {};
+};
+
+/**
+ * Blocking backend that uses the Wire library, each transaction finishes inside start()
+ * Used when DMA isn't enabled and for the zero length probes DMA can't do
+ */
+class Loom_I2CWire : public I2CBackend{
+    public:
+        void start(I2CTransaction& transaction) override;
+        bool poll(I2CTransaction& transaction) override { return true; };
+};
+
+#if defined(ARDUINO_ARCH_SAMD)
+/**
+ * Backend that moves the data between memory and the SERCOM with DMA, the CPU is free while the bytes are clocked out
+ * The SERCOM counts the bytes itself (ADDR.LENEN) so there is nothing to service between bytes
+ */
+class Loom_I2CDMA : public I2CBackend{
+    public:
+        void start(I2CTransaction& transaction) override;
+        bool poll(I2CTransaction& transaction) override;
+        void abort(I2CTransaction& transaction) override;
+
+    private:
+        enum class Phase{
+            IDLE,
+            WRITE,
+            READ
+        };
+
+        Phase phase = Phase::IDLE;          // Which half of the transaction is on the bus
+        Loom_I2CWire wire;                  // Used for zero length transfers
+
+        void startWrite(I2CTransaction& transaction);
+        void startRead(I2CTransaction& transaction);
+        void finishTransfer(I2CTransaction& transaction, I2C_STATUS status);    // Release the bus and set the final status
+};
+#endif
+
+/**
+ * Queues I2C transactions and runs them one at a time in the background so several device reads can be in flight while the CPU does other work
+ * Transactions are advanced whenever the executor runs, wait() blocks on a single transaction the same way delay() would while letting everything else run
+ */
+class Loom_I2CBus{
+    public:
+        // Deleting copy constructor.
+        Loom_I2CBus(const Loom_I2CBus &obj) = delete;
+
+        /* Get an instance of the bus */
+        static Loom_I2CBus* getInstance();
+
+        /**
+         * Swap how transactions are put on the bus, e.g. for a mock when testing off the device
+         * @param backend Backend to use, nullptr goes back to Wire
+         */
+        void setBackend(I2CBackend* backend);
+
+        /**
+         * Use DMA for transfers instead of the blocking Wire calls, only available on the SAMD21
+         * @param enable Whether or not to use DMA
+         */
+        void enableDMA(bool enable);
+
+        /**
+         * Queue a transaction, it is started once everything in front of it has finished
+         * The caller can carry on straight away and find out the result from onComplete or the status, the queue keeps moving whenever the executor runs
+         * @param transaction Transaction to queue, must stay in scope until it finishes
+         * @return False if the queue is full
+         */
+        bool submit(I2CTransaction& transaction);
+
+        /**
+         * Take a transaction out of the queue without calling onComplete, for when its memory is about to be released
+         * @param transaction Transaction that was submitted
+         * @return Whether the transaction was still queued
+         */
+        bool cancel(I2CTransaction& transaction);
+
+        /**
+         * Advance whatever is on the bus and start the next transaction when it finishes
+         * @return Whether there is anything still queued
+         */
+        bool process();
+
+        /**
+         * Wait for a transaction to finish, running everything else in the meantime
+         * @param transaction Transaction that was submitted
+         * @param timeoutMs Longest time to wait, the transaction is removed if it hasn't finished by then
+         * @return Whether the transaction finished successfully
+         */
+        bool wait(I2CTransaction& transaction, uint32_t timeoutMs = I2C_TRANSACTION_TIMEOUT * (MAX_I2C_TRANSACTIONS + 1));
+
+        /**
+         * Write then read in one transaction and wait for it to finish
+         * @param address 7 bit address of the device
+         * @param writeData Bytes to send
+         * @param writeLength Number of bytes to send
+         * @param readData Where to put the bytes read back
+         * @param readLength Number of bytes to read
+         * @return Whether the transaction finished successfully
+         */
+        bool transfer(uint8_t address, const uint8_t* writeData, uint8_t writeLength, uint8_t* readData, uint8_t readLength);
+
+        /**
+         * Send bytes to a device and wait for it to finish
+         * @param address 7 bit address of the device
+         * @param data Bytes to send
+         * @param length Number of bytes to send
+         */
+        bool write(uint8_t address, const uint8_t* data, uint8_t length) { return transfer(address, data, length, nullptr, 0); };
+
+        /**
+         * Read bytes from a device and wait for it to finish
+         * @param address 7 bit address of the device
+         * @param data Where to put the bytes
+         * @param length Number of bytes to read
+         */
+        bool read(uint8_t address, uint8_t* data, uint8_t length) { return transfer(address, nullptr, 0, data, length); };
+
+        /**
+         * Check if a device acknowledges its address
+         * @param address 7 bit address of the device
+         */
+        bool probe(uint8_t address) { return transfer(address, nullptr, 0, nullptr, 0); };
+
+        /**
+         * Latency counters for a device
+         * @param address 7 bit address of the device
+         * @return nullptr if the device hasn't been used yet
+         */
+        const I2CDeviceStats* getStats(uint8_t address);
+
+        /* Print the latency counters for every device */
+        void printStats();
+
+        /* Clear the latency counters */
+        void resetStats() { deviceCount = 0; };
+
+    private:
+        Loom_I2CBus() {};
+
+        I2CTransaction* queue[MAX_I2C_TRANSACTIONS];   // Transactions in the order they were submitted, the first one is on the bus
+        uint8_t queueLength = 0;                        // Number of queued transactions
+
+        I2CDeviceStats stats[MAX_I2C_DEVICES];          // Latency counters
+        uint8_t deviceCount = 0;                        // Number of devices with counters
+
+        Loom_I2CWire wireBackend;                       // Default backend
+#if defined(ARDUINO_ARCH_SAMD)
+        Loom_I2CDMA dmaBackend;                         // Backend used when DMA is enabled
+#endif
+        I2CBackend* backend = &wireBackend;             // Backend transactions are currently run on
+
+        int taskID = -1;                                // Executor task that keeps the queue moving
+
+        void startNext();                               // Put the first queued transaction on the bus
+        void finish(uint8_t index);                     // Remove a finished transaction from the queue, record its latency and call onComplete
+        bool remove(I2CTransaction& transaction);       // Abort a transaction wherever it is in the queue and finish it as timed out
+        void record(const I2CTransaction& transaction); // Update the latency counters
+
+        static uint32_t processTask(void* context);     // Executor task that calls process()
+        static bool isFinished(void* context);          // Condition for wait()
+};
@@ -0,0 +1,86 @@
+#include "Loom_I2CMock.h"
+
+#if defined(LOOM_HOST_TEST)
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CMock::start(I2CTransaction& transaction){
+    transactionCount++;
+
+    MockDevice* device = findDevice(transaction.address, false);
+    if(device == nullptr || !device->present){
+        transaction.status = I2C_STATUS::NACK;
+        return;
+    }
+
+    // Reads leave the last write alone so a register address can be checked after the value is read back
+    if(transaction.writeLength > 0){
+        device->lastWriteLength = min(transaction.writeLength, (uint8_t)I2C_MOCK_BUFFER);
+        memcpy(device->lastWrite, transaction.writeData, device->lastWriteLength);
+    }
+
+    for(int i = 0; i < transaction.readLength; i++)
+        transaction.readData[i] = (i < device->responseLength) ? device->response[i] : 0xFF;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_I2CMock::poll(I2CTransaction& transaction){
+    if(transaction.status == I2C_STATUS::NACK)
+        return true;
+
+    if(micros() - transaction.startTime < latency)
+        return false;
+
+    transaction.status = I2C_STATUS::DONE;
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CMock::setPresent(uint8_t address, bool present){
+    MockDevice* device = findDevice(address, true);
+    if(device != nullptr)
+        device->present = present;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_I2CMock::setResponse(uint8_t address, const uint8_t* data, uint8_t length){
+    MockDevice* device = findDevice(address, true);
+    if(device == nullptr)
+        return;
+
+    device->present = true;
+    device->responseLength = min(length, (uint8_t)I2C_MOCK_BUFFER);
+    memcpy(device->response, data, device->responseLength);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint8_t Loom_I2CMock::getLastWrite(uint8_t address, uint8_t* data, uint8_t maxLength){
+    MockDevice* device = findDevice(address, false);
+    if(device == nullptr)
+        return 0;
+
+    uint8_t length = min(device->lastWriteLength, maxLength);
+    memcpy(data, device->lastWrite, length);
+    return length;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+Loom_I2CMock::MockDevice* Loom_I2CMock::findDevice(uint8_t address, bool create){
+    for(int i = 0; i < deviceCount; i++){
+        if(devices[i].address == address)
+            return &devices[i];
+    }
+
+    if(!create || deviceCount >= MAX_I2C_DEVICES)
+        return nullptr;
+
+    devices[deviceCount].address = address;
+    return &devices[deviceCount++];
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+// The mock is only built for the host tests in tests/Host so it never takes up space in the firmware
+#if defined(LOOM_HOST_TEST)
+
+#include "Loom_I2CBus.h"
+
+#define I2C_MOCK_BUFFER 32                  // Most bytes stored for a scripted response or a recorded write
+
+/**
+ * Backend that doesn't touch the hardware, devices and their responses are scripted so drivers can be exercised off the device
+ * Install it with Loom_I2CBus::getInstance()->setBackend(&mock)
+ */
+class Loom_I2CMock : public I2CBackend{
+    public:
+        void start(I2CTransaction& transaction) override;
+        bool poll(I2CTransaction& transaction) override;
+        void abort(I2CTransaction& transaction) override { transaction.status = I2C_STATUS::TIMEOUT; };
+
+        /**
+         * Add or remove a device, transactions to missing devices are NACKed
+         * @param address 7 bit address of the device
+         * @param present Whether or not the device acknowledges
+         */
+        void setPresent(uint8_t address, bool present);
+
+        /**
+         * Bytes the device returns whenever it is read, reads longer than this are padded with 0xFF like a floating bus
+         * @param address 7 bit address of the device, added if it isn't present yet
+         * @param data Bytes to return
+         * @param length Number of bytes
+         */
+        void setResponse(uint8_t address, const uint8_t* data, uint8_t length);
+
+        /**
+         * How long each transaction stays on the bus before it finishes, to exercise queueing and timeouts
+         * @param micros Microseconds per transaction
+         */
+        void setLatency(uint32_t micros) { latency = micros; };
+
+        /**
+         * Copy out the last bytes written to a device
+         * @param address 7 bit address of the device
+         * @param data Where to put the bytes
+         * @param maxLength Size of the buffer
+         * @return Number of bytes copied
+         */
+        uint8_t getLastWrite(uint8_t address, uint8_t* data, uint8_t maxLength);
+
+        /* Total transactions started on the mock */
+        uint32_t getTransactionCount() { return transactionCount; };
+
+    private:
+        /**
+         * Scripted device
+         */
+        struct MockDevice{
+            uint8_t address = 0;
+            bool present = false;
+            uint8_t response[I2C_MOCK_BUFFER];
+            uint8_t responseLength = 0;
+            uint8_t lastWrite[I2C_MOCK_BUFFER];
+            uint8_t lastWriteLength = 0;
+        };
+
+        MockDevice devices[MAX_I2C_DEVICES];    // Scripted devices
+        uint8_t deviceCount = 0;                // Number of scripted devices
+        uint32_t latency = 0;                   // Microseconds each transaction takes
+        uint32_t transactionCount = 0;          // Transactions started
+
+        MockDevice* findDevice(uint8_t address, bool create);
+};
+
+#endif
@@ -2,8 +2,34 @@
 #include "Logger.h"
 Logger* Logger::instance = nullptr;
 
+// Duplicate modules get their address appended to their name, so a base name matches "SHT31" as well as "SHT31_68"
+static bool moduleNameMatches(const char* baseName, const char* moduleName){
+    if(moduleName == nullptr)
+        return false;
+
+    size_t length = strlen(baseName);
+    return strncmp(baseName, moduleName, length) == 0 && (moduleName[length] == '\0' || moduleName[length] == '_');
+}
+
+// The arena document is only given memory once initialize() knows how much the modules need
+#if defined(MANAGER_ARENA_ENABLE)
+    #define INITIAL_DOCUMENT_SIZE 0
+#else
+    #define INITIAL_DOCUMENT_SIZE MAX_JSON_SIZE
+#endif
+
+// FNV-1a hash of a module name, used to remember which modules have already been sent a field scale and which columns belong to which module
+static uint32_t hashName(const char* name){
+    uint32_t hash = 2166136261UL;
+    while(*name != '\0'){
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Manager::Manager(const char* devName, uint32_t instanceNum) : instanceNumber(instanceNum), doc(MAX_JSON_SIZE) {
+Manager::Manager(const char* devName, uint32_t instanceNum) : instanceNumber(instanceNum), doc(INITIAL_DOCUMENT_SIZE) {
     strncpy(this->deviceName, devName, 100);
     Logger::getInstance();
 }
@@ -40,7 +66,7 @@ Manager::Manager(const char* devName, uint32_t instanceNum) : instanceNumber(ins
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-DynamicJsonDocument& Manager::getDocument() {return doc;}
+JsonDocument& Manager::getDocument() {return doc;}
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -66,9 +92,31 @@ void Manager::measure() {
     char noInitLog[50];
     if(hasInitialized){
        LOG(F("** Measuring **"));
+
+       // Record how long it took to get from waking up to the first sample
+       if(wakePending){
+            wakeLatency = millis() - wakeTime;
+            wakePending = false;
+       }
+
+       // Modules with a schedule are skipped until they are due
+       updateSchedule();
+
+       // Start every conversion first so the warm up times overlap instead of adding up
+       std::vector<Module*> pending;
+       unsigned long measureTimeout = MEASURE_TIMEOUT;
        for(int i = 0; i < modules.size(); i++){
-            if(modules[i].second->moduleInitialized)
-                modules[i].second->measure();
+            if(!modules[i].second->sampleDue)
+                continue;
+
+            if(modules[i].second->moduleInitialized){
+                modules[i].second->beginSampling();
+                modules[i].second->startMeasurement();
+                pending.push_back(modules[i].second);
+
+                // Modules taking several samples get the time they spend waiting between and converting each extra sample on top of the usual timeout
+                measureTimeout = max(measureTimeout, MEASURE_TIMEOUT + modules[i].second->getSamplingTime());
+            }
             else{
 
                 /* Converted warning from printModuleName to logger*/
@@ -78,6 +126,44 @@ void Manager::measure() {
             }
             TIMER_RESET;
         }
+
+        // Collect the results in whatever order they finish, modules that don't split their measurement are measured here
+        unsigned long startTime = millis();
+        while(pending.size() > 0 && millis() - startTime < measureTimeout){
+            for(int i = 0; i < pending.size(); i++){
+
+                // Modules taking several samples stay pending between them and start the next one once it is due
+                if(pending[i]->isWaitingToSample()){
+                    pending[i]->startNextSample();
+                }
+                else if(pending[i]->isMeasurementReady()){
+                    pending[i]->collectMeasurement();
+                    if(!pending[i]->addSample()){
+                        pending.erase(pending.begin() + i);
+                        i--;
+                    }
+                    else{
+
+                        // The first sample shows how long the rest will take for modules that don't know their conversion time
+                        measureTimeout = max(measureTimeout, MEASURE_TIMEOUT + pending[i]->getSamplingTime());
+                    }
+                }
+                TIMER_RESET;
+            }
+
+            // Let any background work run while the sensors are converting
+            Loom_Executor::getInstance()->runPending();
+        }
+
+        // Anything still waiting gets whatever it has so far so the rest of the cycle can continue
+        for(int i = 0; i < pending.size(); i++){
+            WARNINGF("%s did not finish measuring in time!", pending[i]->getModuleName());
+            if(!pending[i]->isWaitingToSample()){
+                pending[i]->collectMeasurement();
+                pending[i]->addSample();
+            }
+            pending[i]->finishSampling();
+        }
     }
     else{
             ERROR(F("Unable to collect data as the manager and thus all sensors connected to it have not been initialized! Call manager.initialize() to fix this."));
@@ -96,6 +182,7 @@ void Manager::package(){
     
     // Clear the document so that we don't get null characters after too many updates
     doc.clear();
+    clearSerializationCache();
     doc[F("type")] = F("data");
     doc["id"]["name"] = get_device_name();
     doc["id"]["instance"] = get_instance_num();
@@ -109,9 +196,18 @@ void Manager::package(){
     JsonObject json = get_data_object("Packet");
     json["Number"] = packetNumber;
 
+    // Reserve the overflow counter before the modules fill the document so there is always room to report it
+    json["Overflows"] = overflowCount;
+
     for(int i = 0; i < modules.size(); i++){
+        // Only package the modules that were measured this cycle
+        if(!modules[i].second->sampleDue)
+            continue;
+
         if(modules[i].second->moduleInitialized){
             modules[i].second->package();
+            if(modules[i].second->hasStatistics())
+                modules[i].second->packageStatistics(get_data_object(modules[i].second->getModuleName()));
         } else{
             /* Converted warning from printModuleName to logger*/
             memset(noInitLog, '\0', 50);
@@ -120,6 +216,21 @@ void Manager::package(){
         }
         TIMER_RESET;
     }
+
+    // Convert scaled fields to integers once every module has added its data
+    applyFieldScales();
+
+    // ArduinoJson silently drops anything that doesn't fit so we need to check and report it ourselves
+    if(doc.overflowed()){
+        overflowCount++;
+        json["Overflows"] = overflowCount;
+        WARNINGF("JSON document ran out of space while packaging, some data was dropped! (%u bytes used of %u)", doc.memoryUsage(), doc.capacity());
+    }
+
+    // Only keep the counter in the packet once an overflow has actually occurred
+    else if(overflowCount == 0){
+        json.remove("Overflows");
+    }
     packetNumber++;
     
     LOG(F("** Packaging Complete **"));
@@ -129,6 +240,9 @@ void Manager::package(){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 JsonObject Manager::get_data_object(const char* moduleName){
+    // The caller is about to modify the document so anything previously serialized is out of date
+    clearSerializationCache();
+
     // Check if the key already exists in the array
     for(JsonVariant value : contentsArray){
 
@@ -145,6 +259,155 @@ JsonObject Manager::get_data_object(const char* moduleName){
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Manager::setFieldScale(const char* moduleName, const char* fieldName, uint8_t decimals){
+    if(decimals > MAX_SCALE_DECIMALS){
+        WARNINGF("Scale of %u decimals for %s/%s is too large, using %u instead", decimals, moduleName, fieldName, MAX_SCALE_DECIMALS);
+        decimals = MAX_SCALE_DECIMALS;
+    }
+
+    uint32_t factor = 1;
+    for(int i = 0; i < decimals; i++){
+        factor *= 10;
+    }
+
+    // If the field is already scaled just update the factor, receivers need to be sent the new one
+    for(int i = 0; i < fieldScales.size(); i++){
+        if(strcmp(fieldScales[i].moduleName, moduleName) == 0 && strcmp(fieldScales[i].fieldName, fieldName) == 0){
+            fieldScales[i].factor = factor;
+            fieldScales[i].sentTo.clear();
+            return;
+        }
+    }
+
+    fieldScales.push_back(FieldScale{Loom_Arena::getInstance()->copyString(moduleName), Loom_Arena::getInstance()->copyString(fieldName), factor});
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Manager::requestSchema(){
+    for(int i = 0; i < fieldScales.size(); i++)
+        fieldScales[i].sentTo.clear();
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t Manager::getFieldScale(const char* moduleName, const char* fieldName){
+    for(int i = 0; i < fieldScales.size(); i++){
+        if(moduleNameMatches(fieldScales[i].moduleName, moduleName) && strcmp(fieldScales[i].fieldName, fieldName) == 0)
+            return fieldScales[i].factor;
+    }
+    return 1;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Manager::applyFieldScales(){
+    for(int i = 0; i < fieldScales.size(); i++){
+
+        // Drop decimals until every value carrying the field fits in a 32-bit integer, all of them are checked first so one packet never mixes two scales
+        uint32_t factor = fieldScales[i].factor;
+        for(JsonVariant entry : contentsArray){
+            JsonObject moduleObject = entry.as<JsonObject>();
+            if(!moduleNameMatches(fieldScales[i].moduleName, moduleObject["module"].as<const char*>()))
+                continue;
+
+            JsonVariant value = moduleObject["data"][fieldScales[i].fieldName];
+            if(value.is<float>() && !value.is<long>()){
+                float magnitude = fabsf(value.as<float>());
+                while(factor > 1 && magnitude * factor >= MAX_SCALED_VALUE)
+                    factor /= 10;
+            }
+        }
+
+        // Receivers and the SD header have to be given the new scale
+        if(factor != fieldScales[i].factor){
+            WARNINGF("%s of %s is too large for a scale of %lu, lowering it to %lu", fieldScales[i].fieldName, fieldScales[i].moduleName, (unsigned long)fieldScales[i].factor, (unsigned long)factor);
+            fieldScales[i].factor = factor;
+            fieldScales[i].sentTo.clear();
+            resetCSVLayout();
+        }
+
+        // A base name can match more than one module so check every entry
+        for(JsonVariant entry : contentsArray){
+            JsonObject moduleObject = entry.as<JsonObject>();
+            if(!moduleNameMatches(fieldScales[i].moduleName, moduleObject["module"].as<const char*>()))
+                continue;
+
+            JsonVariant value = moduleObject["data"][fieldScales[i].fieldName];
+            if(value.isNull())
+                continue;
+
+            // Overwriting the float with an integer reuses the same slot so this never takes up extra space, values that don't fit even unscaled (or NaN) are left as floats
+            if(value.is<float>() && !value.is<long>()){
+                float scaled = value.as<float>() * fieldScales[i].factor;
+                if(fabsf(scaled) < MAX_SCALED_VALUE)
+                    value.set(lroundf(scaled));
+            }
+
+            // The scale is only sent the first time each module carries the field after it changes, modules on a slower schedule get it in their next packet
+            uint32_t nameHash = hashName(moduleObject["module"].as<const char*>());
+            if(std::find(fieldScales[i].sentTo.begin(), fieldScales[i].sentTo.end(), nameHash) == fieldScales[i].sentTo.end()){
+                moduleObject["scales"][fieldScales[i].fieldName] = fieldScales[i].factor;
+                fieldScales[i].sentTo.push_back(nameHash);
+            }
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Manager::updateSchedule(){
+    uint32_t now = getScheduleTime();
+
+    for(int i = 0; i < modules.size(); i++){
+        Module* module = modules[i].second;
+
+        // Modules without a period are sampled every time the device wakes
+        if(module->samplePeriod == 0){
+            module->sampleDue = true;
+            continue;
+        }
+
+        module->sampleDue = now + SCHEDULE_TOLERANCE >= module->nextSample;
+        if(module->sampleDue){
+
+            // Deadlines stay on a fixed grid (multiples of the period plus the phase) so late wake ups don't make the schedule drift
+            uint32_t current = now + SCHEDULE_TOLERANCE;
+            uint32_t intoPeriod = (current + module->samplePeriod - (module->samplePhase % module->samplePeriod)) % module->samplePeriod;
+            module->nextSample = current - intoPeriod + module->samplePeriod;
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t Manager::getNextScheduledSample(){
+    uint32_t next = 0;
+    for(int i = 0; i < modules.size(); i++){
+        Module* module = modules[i].second;
+        if(module->samplePeriod == 0 || !module->moduleInitialized)
+            continue;
+
+        // A module that has never been sampled is due straight away
+        uint32_t due = (module->nextSample == 0) ? getScheduleTime() : module->nextSample;
+        if(next == 0 || due < next)
+            next = due;
+    }
+    return next;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Manager::usingSchedule(){
+    for(int i = 0; i < modules.size(); i++){
+        if(modules[i].second->samplePeriod > 0)
+            return true;
+    }
+    return false;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Manager::power_up(){
     FUNCTION_START;
@@ -194,7 +457,6 @@ void Manager::power_down(){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Manager::display_data(){
-    char jsonStr[MAX_JSON_SIZE];
     FUNCTION_START;
     if(!doc.isNull()){
 
@@ -203,9 +465,9 @@ void Manager::display_data(){
             modules[i].second->display_data();
         }
 
-        serializeJsonPretty(doc, jsonStr, MAX_JSON_SIZE);
+        // Share the JSON string with the other sinks rather than serializing the document again
         LOG(F("Data Json: \n"));
-        LOG_LONG(jsonStr);
+        LOG_LONG((char*)getSerialized(FORMAT_JSON).data);
     }
     else{
         LOG(F("JSON Document is Null there is no data to display"));
@@ -229,6 +491,15 @@ void Manager::initialize() {
         modules[i].second->initialize();
     }
     hasInitialized = true;
+
+    // Now that every module knows what it has connected we can size the document to fit
+    allocateDocument();
+
+#if defined(MANAGER_ARENA_ENABLE)
+    LOGF("Arena usage: %u/%u bytes", Loom_Arena::getInstance()->getUsed(), Loom_Arena::getInstance()->getCapacity());
+    if(Loom_Arena::getInstance()->getFailedAllocations() > 0)
+        ERRORF("%u allocations didn't fit in the arena and fell back to the heap, increase ARENA_SIZE!", Loom_Arena::getInstance()->getFailedAllocations());
+#endif
     LOG(F("** Setup Complete ** "));
 
 
@@ -244,6 +515,246 @@ void Manager::getJSONString(char array[MAX_JSON_SIZE]){
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Manager::clearSerializationCache(){
+    for(int i = 0; i < FORMAT_COUNT; i++){
+        serialCache[i].valid = false;
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+SerializedView Manager::getSerialized(SERIAL_FORMAT format){
+    SerializationCache& cache = serialCache[format];
+
+    // Only serialize if the document has changed since this format was last requested
+    if(!cache.valid){
+        if(cache.size == 0){
+            ERROR(F("Serialization buffers have not been sized! Call manager.initialize() first."));
+            return SerializedView{"", 0};
+        }
+
+        // Buffers are only allocated for the formats that are actually used
+        if(cache.buffer == nullptr)
+            cache.buffer = Loom_Arena::getInstance()->allocateString(cache.size);
+
+        switch(format){
+            case FORMAT_JSON:
+                cache.length = serializeJson(doc, cache.buffer, cache.size);
+                break;
+            case FORMAT_MSGPACK:
+                cache.length = serializeMsgPack(doc, cache.buffer, cache.size);
+                break;
+            case FORMAT_CSV:
+                cache.length = serializeCSV(cache.buffer, cache.size);
+                break;
+        }
+
+        // A completely full buffer means the output was most likely cut off
+        if(cache.length >= cache.size - 1){
+            WARNINGF("Serialized packet filled the entire %u byte buffer and may have been truncated!", cache.size);
+
+            // Measure what the text actually needed so JSON_TEXT_RATIO can be set from a real packet
+            if(format == FORMAT_JSON && doc.memoryUsage() > 0){
+                size_t needed = measureJson(doc) + 1;
+                ERRORF("JSON text needs %u bytes for a %u byte document, set JSON_TEXT_RATIO to at least %u", needed, doc.memoryUsage(), (needed + doc.capacity() - 1) / doc.capacity());
+            }
+        }
+        cache.valid = true;
+    }
+
+    return SerializedView{cache.buffer, cache.length};
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t Manager::writeJSON(Print& output){
+    if(serialCache[FORMAT_JSON].valid)
+        return output.write((const uint8_t*)serialCache[FORMAT_JSON].buffer, serialCache[FORMAT_JSON].length);
+
+    return serializeJson(doc, output);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t Manager::writeMsgPack(Print& output){
+    if(serialCache[FORMAT_MSGPACK].valid)
+        return output.write((const uint8_t*)serialCache[FORMAT_MSGPACK].buffer, serialCache[FORMAT_MSGPACK].length);
+
+    return serializeMsgPack(doc, output);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t Manager::getSerializedLength(SERIAL_FORMAT format){
+    if(serialCache[format].valid)
+        return serialCache[format].length;
+
+    // JSON and MessagePack can be measured without being written anywhere
+    switch(format){
+        case FORMAT_JSON:
+            return measureJson(doc);
+        case FORMAT_MSGPACK:
+            return measureMsgPack(doc);
+        default:
+            return getSerialized(format).length;
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t Manager::serializeCSV(char* buffer, size_t size){
+    size_t length = snprintf_P(buffer, size, PSTR("%s,%i,"), get_device_name(), get_instance_num());
+    if(length >= size)
+        return size - 1;
+
+    // If there is a key that contains timestamp data when need to include that separately 
+    if(doc.containsKey("timestamp")){
+        char utcArr[21];
+        char localArr[21];
+        memset(utcArr, '\0', 21);
+        memset(localArr, '\0', 21);
+        strncpy(utcArr, doc["timestamp"]["time_utc"].as<const char*>(), 20);
+        strncpy(localArr, doc["timestamp"]["time_local"].as<const char*>(), 20);
+
+        // Format date with spaces when logging to SD
+        char *indexPointer = strchr(utcArr, 'Z');
+        if(indexPointer != nullptr){
+            utcArr[10] = ' ';
+            utcArr[indexPointer-utcArr] = '\0';
+        }
+
+        // Format date with spaces when logging to SD
+        indexPointer = strchr(localArr, 'Z');
+        if(indexPointer != nullptr){
+            localArr[10] = ' ';
+            localArr[indexPointer-localArr] = '\0';
+        }
+
+        length += snprintf_P(buffer + length, size - length, PSTR("%s,%s,"), utcArr, localArr);
+        if(length >= size)
+            return size - 1;
+    }
+
+    JsonArray contents = doc["contents"].as<JsonArray>();
+
+    // Modules seen for the first time get their columns added to the end of the row
+    for(JsonVariant v : contents) {
+        uint32_t moduleHash = hashName(v.as<JsonObject>()["module"].as<const char*>());
+        size_t fieldCount = v.as<JsonObject>()["data"].as<JsonObject>().size();
+
+        bool found = false;
+        for(int i = 0; i < csvLayout.size() && !found; i++){
+            if(csvLayout[i].moduleHash == moduleHash){
+                csvLayout[i].fieldCount = max(csvLayout[i].fieldCount, fieldCount);
+                found = true;
+            }
+        }
+
+        if(!found)
+            csvLayout.push_back(CSVColumnGroup{moduleHash, fieldCount});
+    }
+
+    // Modules that didn't package this cycle (not due yet, or a sensor that stopped answering) are left as empty columns so the row still lines up with the header
+    for(int i = 0; i < csvLayout.size(); i++){
+        JsonObject data;
+        for(JsonVariant v : contents) {
+            if(hashName(v.as<JsonObject>()["module"].as<const char*>()) == csvLayout[i].moduleHash){
+                data = v.as<JsonObject>()["data"].as<JsonObject>();
+                break;
+            }
+        }
+
+        length = appendCSVFields(buffer, size, length, data);
+        for(size_t empty = data.size(); empty < csvLayout[i].fieldCount && length + 1 < size; empty++){
+            buffer[length++] = ',';
+            buffer[length] = '\0';
+        }
+    }
+
+    return length;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t Manager::appendCSVFields(char* buffer, size_t size, size_t length, JsonObject data){
+    for(JsonPair keyValue : data){
+        if(length + 1 >= size)
+            return size - 1;
+
+        // Strings are written as is, everything else is formatted the same way it would be in JSON
+        if(keyValue.value().is<const char*>())
+            length += strlcpy(buffer + length, keyValue.value().as<const char*>(), size - length);
+        else
+            length += serializeJson(keyValue.value(), buffer + length, size - length);
+
+        if(length + 1 >= size)
+            return size - 1;
+
+        buffer[length++] = ',';
+        buffer[length] = '\0';
+    }
+
+    return length;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Manager::allocateDocument(){
+    size_t capacity = documentSize;
+
+    // If the user didn't specify a size ask each module what its worst case is
+    if(capacity == 0){
+
+        // Root object (type, id, contents, timestamp), the id object and the packet number
+        capacity = JSON_OBJECT_SIZE(4) + JSON_OBJECT_SIZE(3) + MODULE_PACKAGE_SIZE(2);
+        for(int i = 0; i < modules.size(); i++){
+            capacity += modules[i].second->getPackageSize() + modules[i].second->getStatisticsPackageSize();
+        }
+
+        // Room for the scales object in the packets that carry the schema
+        capacity += fieldScales.size() * JSON_OBJECT_SIZE(2);
+
+        // A received packet replaces the local data rather than being added to it
+        for(int i = 0; i < modules.size(); i++){
+            capacity = max(capacity, modules[i].second->getReceiveSize());
+        }
+    }
+
+#if defined(MANAGER_ARENA_ENABLE)
+    // The arena document is sized once, it and the serialization buffers have to fit in what is left of the arena
+    if(doc.capacity() == 0){
+        size_t available = Loom_Arena::getInstance()->getCapacity() - Loom_Arena::getInstance()->getUsed();
+        size_t needed = capacity + FORMAT_COUNT * JSON_TEXT_SIZE(capacity);
+        if(needed > available){
+            capacity = available / (1 + FORMAT_COUNT * JSON_TEXT_SIZE(1));
+            ERRORF("Registered modules need %u bytes of arena but only %u are left, increase ARENA_SIZE! The document is limited to %u bytes and packets will be truncated", needed, available, capacity);
+        }
+        doc.reserve(capacity);
+    }
+    else if(capacity > doc.capacity()){
+        ERRORF("Registered modules need up to %u bytes but the arena document was already sized to %u", capacity, doc.capacity());
+    }
+    capacity = doc.capacity();
+#else
+    // Replace the default sized document with one that fits the modules, this is the only time it is reallocated
+    if(capacity != doc.capacity()){
+        doc = DynamicJsonDocument(capacity);
+    }
+#endif
+
+    // Serialization buffers are only ever sized once, MessagePack and CSV are never larger than the JSON text
+    if(serialCache[FORMAT_JSON].size == 0){
+        for(int i = 0; i < FORMAT_COUNT; i++){
+            serialCache[i].size = JSON_TEXT_SIZE(capacity);
+        }
+    }
+    clearSerializationCache();
+
+    LOGF("JSON document sized to %u bytes, serialization buffers %u bytes", doc.capacity(), serialCache[FORMAT_JSON].size);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Manager::read_serial_num(){
     char serial_no[33];
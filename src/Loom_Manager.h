@@ -3,11 +3,35 @@
 #include <ArduinoJson.h>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
 
 #include "Module.h"
+#include "Loom_Arena.h"
 
 #define WAIT_TIME_MS 20000     // Time to wait for the serial interface to start
 #define BAUD_RATE 115200        // Serial interface baud rate
+#define MEASURE_TIMEOUT 60000    // Longest time in milliseconds to wait for every module to finish measuring
+#define SCHEDULE_TOLERANCE 2    // Seconds early a scheduled module can be woken and still count as due, the RTC alarm only has 1 second resolution
+#define MAX_SCALE_DECIMALS 6    // Largest number of decimal places a field can be scaled by, the scale is lowered at runtime for values that wouldn't fit in a 32-bit integer
+#define MAX_SCALED_VALUE 2147483520.0f  // Largest float below 2^31, scaled values have to stay under it to be rounded to a 32-bit integer
+
+/**
+ * Formats the Manager document can be serialized in
+ */
+enum SERIAL_FORMAT{
+    FORMAT_JSON,            // Compact JSON string
+    FORMAT_MSGPACK,         // Binary MessagePack
+    FORMAT_CSV,             // Single CSV row matching the SD card headers
+    FORMAT_COUNT
+};
+
+/**
+ * Read-only view of the document serialized in one format, valid until the next call to package()
+ */
+struct SerializedView{
+    const char* data;       // Serialized output, null terminated for the text formats
+    size_t length;          // Number of bytes of output
+};
 
 /**
  * Unifies all the various sensors to allow for collection in unison
@@ -35,7 +59,7 @@ class Manager{
          * Get a reference to the JSON document that sensor data is stored in
          * @return reference to the main JSON document
          */ 
-        DynamicJsonDocument& getDocument(); // Returns a reference to the main JSON document storing 
+        JsonDocument& getDocument(); // Returns a reference to the main JSON document storing 
 
         /**
          * Add a random piece of data to the overall JSON package in the given module name with a name for the data
@@ -49,6 +73,40 @@ class Manager{
             json[dataName] = data;
         };
 
+        /**
+         * Get the current document serialized in the given format
+         * Each format is only serialized once per package() so every sink in a cycle shares the same output
+         * @param format Format to serialize the document in
+         * @return Read-only view of the serialized data, valid until the document changes
+         */
+        SerializedView getSerialized(SERIAL_FORMAT format);
+
+        /**
+         * Stream the document as JSON directly into a sink (File, MqttClient, Serial...) without an intermediate buffer
+         * If the JSON has already been serialized this cycle the cached copy is written instead
+         * @param output Where to write the JSON
+         * @return Number of bytes written
+         */
+        size_t writeJSON(Print& output);
+
+        /**
+         * Stream the document as MessagePack directly into a sink without an intermediate buffer
+         * @param output Where to write the MessagePack
+         * @return Number of bytes written
+         */
+        size_t writeMsgPack(Print& output);
+
+        /**
+         * Get the number of bytes the document takes up in the given format, used by sinks that need to know the length before streaming
+         * @param format Format to measure
+         */
+        size_t getSerializedLength(SERIAL_FORMAT format);
+
+        /**
+         * Mark all cached serializations as out of date, this must be called after modifying the document directly through getDocument()
+         */
+        void clearSerializationCache();
+
         /**
          * Start the Serial interface with some parameters, should we wait up to 20 seconds for the serial interface to open before continuing 
          * @param waitForSerial Whether or not we should wait 20 seconds for the user to open the serial monitor before continuing 
@@ -96,6 +154,69 @@ class Manager{
          * @param array Array to store the string in
          */
         void getJSONString(char array[MAX_JSON_SIZE]);
+
+        /** 
+         * Get the cached JSON serialization of the packet, this is sized at initialize() to fit the registered modules
+         * @return Pointer to the serialized string, valid until the next package()
+         */
+        const char* getJSONString() { return getSerialized(FORMAT_JSON).data; };
+
+        /**
+         * Override the automatically computed document capacity, must be called before initialize()
+         * @param size Size in bytes of the JSON document
+         */
+        void setDocumentSize(size_t size) { documentSize = size; };
+
+        /**
+         * Store a floating point field as a scaled integer to shrink packets and avoid formatting floats, eg. a scale of 2 stores 23.456789 as 2346
+         * The scale is sent once in the first packet (and the SD header) so the receiver can convert the values back, should be called before initialize()
+         * If a value is too large for the scale to fit in a 32-bit integer (eg. 2147.49 with 6 decimals) the scale is lowered for good, the new scale is sent again and the SD card starts a new file
+         * @param moduleName Name of the module the field belongs to, the base name also matches renamed duplicates (eg. SHT31 matches SHT31_68)
+         * @param fieldName Name of the field in the module's data
+         * @param decimals Number of decimal places to keep (0-6)
+         */
+        void setFieldScale(const char* moduleName, const char* fieldName, uint8_t decimals);
+
+        /**
+         * Get the factor a field's value has been multiplied by, 1 if the field is not scaled
+         * @param moduleName Name of the module the field belongs to
+         * @param fieldName Name of the field in the module's data
+         */
+        uint32_t getFieldScale(const char* moduleName, const char* fieldName);
+
+        /**
+         * Set the current time used to decide which modules are due, called by the Hypnos from the RTC on every wake
+         * Without a Hypnos the schedule runs off of millis()
+         * @param unixTime Current time in seconds
+         */
+        void setScheduleTime(uint32_t unixTime) { scheduleTime = unixTime; scheduleMillis = millis(); };
+
+        /**
+         * Get the current time in seconds as seen by the scheduler
+         */
+        uint32_t getScheduleTime() { return scheduleTime + (millis() - scheduleMillis) / 1000; };
+
+        /**
+         * Get the earliest time in seconds a scheduled module is due, used by the Hypnos to set the next alarm
+         * @return Time of the next deadline, 0 if no modules have a schedule
+         */
+        uint32_t getNextScheduledSample();
+
+        /**
+         * Include the field scales in the next packet, eg. when a receiver has restarted and lost them
+         */
+        void requestSchema();
+
+        /**
+         * Work out the CSV columns again, called when modules are plugged in or removed at runtime
+         * The SD card starts a new file so the header matches the new columns
+         */
+        void resetCSVLayout() { csvLayout.clear(); csvLayoutVersion++; };
+
+        /**
+         * Get the number of times the CSV columns have changed, used by the SD card to know when a new header is needed
+         */
+        uint16_t getCSVLayoutVersion() { return csvLayoutVersion; };
     
         /**
          * Gets the current device name set by the user
@@ -132,6 +253,17 @@ class Manager{
          */ 
         void useHypnos() { usingHypnos = true; };  
 
+        /**
+         * Called by the Hypnos when it wakes up, the time from here until the next measure() is recorded as the wake latency
+         * @param wakeMillis millis() when the device woke
+         */
+        void setWakeTime(unsigned long wakeMillis) { wakeTime = wakeMillis; wakePending = true; };
+
+        /**
+         * Get the milliseconds it took from the last wake up until the sensors started measuring
+         */
+        unsigned long getWakeLatency() { return wakeLatency; };
+
         /**
          * Set the current state of the hypnos enable
          * @param state New state of the hypnos board
@@ -149,21 +281,75 @@ class Manager{
          */ 
         int get_packet_number() { return packetNumber; };
 
+        /**
+         * Get the number of times package() ran out of space in the JSON document and dropped data
+         */ 
+        uint32_t get_overflow_count() { return overflowCount; };
+
     private:
 
         /* Device Information */
         char deviceName[100];                                   // Name of the device
         uint32_t instanceNumber;                                // Instance number of the device
         uint32_t packetNumber = 1;                              // Tracks the current packet number
+        uint32_t overflowCount = 0;                             // Number of packets that didn't fit in the JSON document
         char serial_num[33];
 
         void read_serial_num();                                 // Read the serial number out of the feather's registers
+        void allocateDocument();                                // Size the document and serialization buffer to fit the registered modules
+        size_t serializeCSV(char* buffer, size_t size);         // Format the document as a single CSV row
+        size_t appendCSVFields(char* buffer, size_t size, size_t length, JsonObject data);  // Append a module's values to the CSV row, returns the new length
+        void applyFieldScales();                                // Convert the scaled fields to integers and attach the schema if needed
+        void updateSchedule();                                  // Work out which modules are due this cycle and when they are next due
+        bool usingSchedule();                                   // Whether or not any module has a sample period
 
         /* Module Data */
-        DynamicJsonDocument doc;                           // JSON document that will store all sensor information
+#if defined(MANAGER_ARENA_ENABLE)
+        ArenaJsonDocument doc;                                  // JSON document that will store all sensor information, stored in the static arena
+#else
+        DynamicJsonDocument doc;                                // JSON document that will store all sensor information
+#endif
         JsonArray contentsArray;                                // Stores the contents of the modules
         std::vector<std::pair<const char*, Module*>> modules;        // List of modules that have been added to the stack
 
+        /* Document Sizing */
+        size_t documentSize = 0;                                // User specified document capacity, 0 means compute it from the modules
+
+        /* Fixed-Point Fields */
+        struct FieldScale{
+            const char* moduleName;                             // Module the field belongs to, copied into the arena
+            const char* fieldName;                              // Name of the field, copied into the arena
+            uint32_t factor;                                    // Value the field is multiplied by before rounding
+            std::vector<uint32_t> sentTo;                       // Hashes of the module names that have been sent the current factor
+        };
+        std::vector<FieldScale> fieldScales;                    // Fields that are stored as scaled integers
+
+        /* Scheduling */
+        uint32_t scheduleTime = 0;                              // Last time in seconds given to the scheduler
+        uint32_t scheduleMillis = 0;                            // millis() when the schedule time was set, used to keep time while awake
+
+        /* Wake Latency */
+        unsigned long wakeTime = 0;                             // millis() when the Hypnos last woke up
+        bool wakePending = false;                               // Whether the next measure() is the first since waking
+        unsigned long wakeLatency = 0;                          // Milliseconds from the last wake to the first measurement
+
+        // Columns of the CSV row, kept in the order they were first logged so rows still line up when a module is skipped
+        struct CSVColumnGroup{
+            uint32_t moduleHash;                                // Hash of the module the columns belong to, the module may be removed while its columns are still in the file
+            size_t fieldCount;                                  // Number of columns the module takes up
+        };
+        std::vector<CSVColumnGroup> csvLayout;
+        uint16_t csvLayoutVersion = 0;                          // Incremented each time the columns are reset
+
+        /* Serialization Cache */
+        struct SerializationCache{
+            char* buffer = nullptr;                             // Output buffer, allocated once the first time the format is requested
+            size_t size = 0;                                    // Size of the buffer, set at initialize
+            size_t length = 0;                                  // Length of the current output
+            bool valid = false;                                 // Whether the output matches the current document
+        };
+        SerializationCache serialCache[FORMAT_COUNT];           // One cached output per format
+
         /* Validation */
         bool hasInitialized = false;                            // Whether or not the initialize function has been called, if not it could be the source of hanging so we want to know
         bool usingHypnos = false;                               // If the setup is using a hypnos
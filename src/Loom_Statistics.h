@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Arduino.h"
+
+/**
+ * Running mean, variance, minimum and maximum of a value
+ * Uses Welford's online algorithm so the memory used doesn't grow with the number of samples and the variance doesn't lose precision subtracting large sums
+ */
+struct SampleStatistics{
+    uint16_t count = 0;                 // Samples added, NaN readings aren't counted
+    float mean = 0;                     // Mean of the samples
+    float minimum = 0;                  // Smallest sample
+    float maximum = 0;                  // Largest sample
+    float m2 = 0;                       // Sum of the squared differences from the mean
+
+    /* Forget every sample */
+    void reset() { count = 0; mean = 0; minimum = 0; maximum = 0; m2 = 0; };
+
+    /**
+     * Add a sample, failed readings reported as NaN are skipped
+     * @param value Sample to add
+     */
+    void add(float value){
+        if(isnan(value))
+            return;
+
+        count++;
+        if(count == 1){
+            minimum = value;
+            maximum = value;
+        }
+        else{
+            minimum = min(minimum, value);
+            maximum = max(maximum, value);
+        }
+
+        float delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+    };
+
+    /* Sample variance of the values added so far */
+    float variance() const { return (count > 1) ? m2 / (count - 1) : 0; };
+
+    /* Sample standard deviation of the values added so far */
+    float stddev() const { return sqrt(variance()); };
+};
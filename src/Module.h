@@ -5,6 +5,10 @@
 #include <string.h>
 #include <ArduinoJson.h>
 #include <Adafruit_SleepyDog.h>
+#include <vector>
+
+#include "Loom_Executor.h"
+#include "Loom_Statistics.h"
 
 /* Watchdog Timer Setup */
 #define WATCHDOG_TIMEOUT 8000
@@ -21,7 +25,37 @@
 #endif
 
 #define OUTPUT_SIZE 256
-#define MAX_JSON_SIZE 2000
+
+// Upper bound on the document size, used by the arena document and anything receiving packets from other devices
+#ifndef MAX_JSON_SIZE
+    #define MAX_JSON_SIZE 2000
+#endif
+
+/* Document Sizing */
+#define DEFAULT_PACKAGE_FIELDS 4                                // Number of fields assumed for modules that don't declare their own package size
+
+// Worst-case bytes a module takes up in the Manager document: the entry in the contents array, the {"module", "data"} object and the data fields
+#define MODULE_PACKAGE_SIZE(fields) (JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(fields))
+
+// Serialized JSON relative to the document holding it, each value takes a 16 byte slot in the document while its "key":value text depends on the key and the digits sent
+// Long field names can go past it, the Manager measures the text when a packet doesn't fit and reports the ratio it needs
+#ifndef JSON_TEXT_RATIO
+    #define JSON_TEXT_RATIO 2
+#endif
+#define JSON_TEXT_SIZE(documentSize) ((documentSize) * JSON_TEXT_RATIO)
+
+/* Multi-sample Measurements */
+#define STATISTICS_FIELDS 3                                     // Fields packaged per value when statistics are enabled: _Min, _Max and _SD
+#define STATISTICS_KEY_SIZE 50                                  // Longest field name a statistic can be packaged under
+
+/**
+ * Value a module averages when it takes several samples per measurement
+ */
+struct SampleField{
+    const char* name;                                           // Name the value is packaged under, the statistics are packaged as <name>_Min, <name>_Max and <name>_SD
+    float* value;                                               // The module's copy of the value, replaced with the mean once every sample has been taken
+    SampleStatistics stats;                                     // Statistics over the samples taken so far
+};
 
 /**
  *  General overarching interface to provide basic unified functionality
@@ -48,12 +82,175 @@ class Module{
         virtual void power_up() = 0;                        // Power the sensor up and come out of sleep
         virtual void power_down() = 0;                      // Power the sensor down to prepare for sleep
 
+        /**
+         * Split measurement, lets the manager start every module's conversion before waiting on any of them
+         * By default the whole measure() call happens in collectMeasurement() so modules that don't split their measurement still work
+         */
+        virtual void startMeasurement() {};                 // Kick off a conversion/warm up, must not block
+        virtual bool isMeasurementReady() { return true; }; // Whether or not the result of the conversion can be read yet, polled by the manager
+        virtual void collectMeasurement() { measure(); };   // Read in the result of the conversion
+
         // Not required overrides
         virtual void display_data() {};                     // Called by the manager to allow OLED to display data at the same time as manager.display_data  
+        virtual size_t getPackageSize() { return MODULE_PACKAGE_SIZE(DEFAULT_PACKAGE_FIELDS); };   // Worst-case number of bytes package() adds to the Manager document, called after initialize()
+        virtual size_t getReceiveSize() { return 0; };      // Largest packet the module loads into the Manager document in place of the local data, 0 if it never does
+        virtual uint32_t getConversionTime() { return 0; }; // Milliseconds from startMeasurement() until the result is ready, 0 if unknown
+
+        /**
+         * Only measure and package this module every period seconds instead of every time the device wakes
+         * @param period Seconds between samples, 0 samples the module every cycle
+         * @param phase Offset in seconds into the period, lets modules with the same period be staggered
+         */
+        void setSchedule(uint32_t period, uint32_t phase = 0) { samplePeriod = period; samplePhase = phase; nextSample = 0; };
+
+        /**
+         * Take several samples every time the module is measured and report their mean, only works for modules that register their values with addSampleField(), the rest take a single sample and say so
+         * The samples are taken by the manager so other modules keep measuring while this one waits between samples
+         * @param samples Number of samples per measurement
+         * @param spacing Milliseconds from collecting one sample to starting the next
+         * @param packageStatistics Also package the min, max and standard deviation of each value
+         */
+        void setSampling(uint8_t samples, uint32_t spacing = 0, bool packageStatistics = false) {
+            sampleCount = max(samples, (uint8_t)1);
+            sampleSpacing = spacing;
+            packageStats = packageStatistics;
+            if(sampleFields.empty() && (sampleCount > 1 || packageStats))
+                printModuleName("Module doesn't report any values that can be sampled, only one sample will be taken");
+        };
+
+        /* Called by the manager around each measurement to take every sample */
+        void beginSampling() {
+            samplesTaken = 0;
+            waitingToSample = false;
+            sampleStartTime = millis();
+            for(int i = 0; i < sampleFields.size(); i++)
+                sampleFields[i].stats.reset();
+        };
+
+        /**
+         * Add the values from the measurement that was just collected
+         * @return Whether another sample still needs to be taken
+         */
+        bool addSample() {
+            sampleDuration = max(sampleDuration, (uint32_t)(millis() - sampleStartTime));
+            if(sampleFields.empty() || (sampleCount <= 1 && !packageStats))
+                return false;
+
+            for(int i = 0; i < sampleFields.size(); i++)
+                sampleFields[i].stats.add(*sampleFields[i].value);
+
+            if(++samplesTaken < sampleCount){
+                waitingToSample = true;
+                nextSampleTime = millis() + sampleSpacing;
+                return true;
+            }
+
+            finishSampling();
+            return false;
+        };
+
+        /**
+         * Start the next sample once the spacing has passed
+         * @return Whether the sample was started
+         */
+        bool startNextSample() {
+            if((long)(millis() - nextSampleTime) < 0)
+                return false;
+
+            waitingToSample = false;
+            sampleStartTime = millis();
+            startMeasurement();
+            return true;
+        };
+
+        /* Replace each value with the mean of the samples taken so far */
+        void finishSampling() {
+            waitingToSample = false;
+            for(int i = 0; i < sampleFields.size(); i++){
+                if(sampleFields[i].stats.count > 0)
+                    *sampleFields[i].value = sampleFields[i].stats.mean;
+            }
+        };
+
+        /* Whether the module is waiting out the spacing before its next sample */
+        bool isWaitingToSample() { return waitingToSample; };
+
+        /* Longest extra time taking every sample adds to a measurement, each sample after the first waits out the spacing and then converts, taking as long as the slowest sample so far */
+        uint32_t getSamplingTime() { return (sampleCount - 1) * (sampleSpacing + max(getConversionTime(), sampleDuration)); };
+
+        /* Whether package() should be followed by the statistics of each value */
+        bool hasStatistics() { return packageStats && !sampleFields.empty(); };
+
+        /**
+         * Add the min, max and standard deviation of each value to the module's data object
+         * @param json Data object for the module
+         */
+        void packageStatistics(JsonObject json) {
+            char key[STATISTICS_KEY_SIZE];
+            for(int i = 0; i < sampleFields.size(); i++){
+                const SampleStatistics& stats = sampleFields[i].stats;
+                if(stats.count == 0)
+                    continue;
+
+                snprintf_P(key, STATISTICS_KEY_SIZE, PSTR("%s_Min"), sampleFields[i].name);
+                json[key] = stats.minimum;
+                snprintf_P(key, STATISTICS_KEY_SIZE, PSTR("%s_Max"), sampleFields[i].name);
+                json[key] = stats.maximum;
+                snprintf_P(key, STATISTICS_KEY_SIZE, PSTR("%s_SD"), sampleFields[i].name);
+                json[key] = stats.stddev();
+            }
+        };
+
+        /* Worst-case bytes packageStatistics() adds to the Manager document, the keys are copied into the document */
+        size_t getStatisticsPackageSize() {
+            if(!hasStatistics())
+                return 0;
+
+            size_t size = JSON_OBJECT_SIZE(STATISTICS_FIELDS * sampleFields.size());
+            for(int i = 0; i < sampleFields.size(); i++)
+                size += STATISTICS_FIELDS * (strlen(sampleFields[i].name) + 5);
+            return size;
+        };
 
         bool moduleInitialized = true;                      // Whether or not the module initialized successfully true until set otherwise
         int module_address = -1;                            // Specifically for I2C addresses, -1 means the module doesn't have an address
+
+        /* Scheduling */
+        bool sampleDue = true;                              // Set by the manager each cycle, whether the module is measured and packaged this cycle
+        uint32_t samplePeriod = 0;                          // Seconds between samples, 0 means every cycle
+        uint32_t samplePhase = 0;                           // Offset in seconds into the period
+        uint32_t nextSample = 0;                            // Time in seconds the module is next due, 0 means the next cycle
+    protected:
+
+        /**
+         * Register a value that is averaged when the module takes several samples, call from the constructor
+         * @param name Name the value is packaged under
+         * @param value The module's copy of the value, read after every sample and replaced with the mean at the end
+         */
+        void addSampleField(const char* name, float* value) { sampleFields.push_back({name, value, SampleStatistics()}); };
+
+        /* Runs each phase of a split measurement back to back, used as measure() by modules that override the split measurement calls */
+        void runMeasurement() {
+            startMeasurement();
+            while(!isMeasurementReady()){
+                TIMER_RESET;
+                Loom_Executor::getInstance()->wait(1);
+            }
+            collectMeasurement();
+        };
+
     private:
         char moduleName[100];
+
+        /* Multi-sample Measurements */
+        std::vector<SampleField> sampleFields;              // Values averaged across samples
+        uint8_t sampleCount = 1;                            // Samples taken per measurement
+        uint8_t samplesTaken = 0;                           // Samples taken so far in the current measurement
+        uint32_t sampleSpacing = 0;                         // Milliseconds between samples
+        unsigned long nextSampleTime = 0;                   // millis() when the next sample can be started
+        unsigned long sampleStartTime = 0;                  // millis() when the current sample was started
+        uint32_t sampleDuration = 0;                        // Longest time in milliseconds a sample has taken from being started to being collected
+        bool waitingToSample = false;                       // Whether the module is waiting to start its next sample
+        bool packageStats = false;                          // Whether the statistics are packaged along with the mean
         
 };
\ No newline at end of file
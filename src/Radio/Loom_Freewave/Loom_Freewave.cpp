@@ -92,11 +92,10 @@ bool Loom_Freewave::receive(uint maxWaitTime){
         LOG(F("Packet Received!"));
         signalStrength = driver.lastRssi();
         recvStatus = bufferToJson(buffer);
-        size_t jsonSize = measureJson(recvDoc)+1;
-        recvData = (char *) malloc(jsonSize);
-        serializeJson(recvDoc, recvData, jsonSize);
-        deserializeJson(manInst->getDocument(), recvData);
-        free(recvData);
+
+        // Deep copy the received packet straight into the manager instead of round tripping through a JSON string
+        manInst->getDocument().set(recvDoc);
+        manInst->clearSerializationCache();
 
         // Update device name
         manInst->set_device_name(manInst->getDocument()["id"]["name"].as<const char*>());
@@ -114,15 +113,14 @@ bool Loom_Freewave::receive(uint maxWaitTime){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 bool Loom_Freewave::send(const uint8_t destinationAddress){
-    uint8_t buffer[maxMessageLength];
-
-    // Try to write the JSON to the buffer
-    if(!jsonToBuffer(buffer, manInst->getDocument().as<JsonObject>())){
+    // Reuse the MsgPack the manager already produced this cycle
+    SerializedView packed = manInst->getSerialized(FORMAT_MSGPACK);
+    if(packed.length == 0 || packed.length > maxMessageLength){
         ERROR(F("Failed to convert JSON to MsgPack"));
         return false;
     }
 
-    if(!manager->sendtoWait((uint8_t*)buffer, sizeof(buffer), destinationAddress)){
+    if(!manager->sendtoWait((uint8_t*)packed.data, packed.length, destinationAddress)){
         ERROR(F("Failed to send packet to specified address!"));
         return false;
     }
@@ -62,6 +62,7 @@ class Loom_Freewave : public Radio{
          * Package basic data about the device
          */ 
         void package() override;
+        size_t getReceiveSize() override { return MAX_JSON_SIZE; };  // Received packets replace the contents of the Manager document so it needs to fit a full packet
 
         /**
          * Power up the module
@@ -81,8 +82,6 @@ class Loom_Freewave : public Radio{
     private:
         Manager* manInst;                       // Instance of the manager
 
-        char* recvData;
-
         HardwareSerial& serial1;                // Serial reference
         RH_Serial driver;                       // Freewave Driver
         RHReliableDatagram* manager;             // Manager for driver
@@ -112,9 +112,7 @@ void Loom_LoRa::initialize() {
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_LoRa::power_up() {
     if (batchSD) {
-        int currentBatch = batchSD->getCurrentBatch();
-        int batchSize = batchSD->getBatchSize();
-        poweredUp = currentBatch == batchSize - 1;
+        poweredUp = batchSD->shouldPowerUp();
     }
 
     if (poweredUp) {
@@ -288,6 +286,7 @@ bool Loom_LoRa::handleFragBody(JsonDocument &workingDoc,
     if (partialPacket->remainingFragments == 0) { 
         // overwrite the manager document by deep-copying the finalized packet
         manager->getDocument().set(partialPacket->working);
+        manager->clearSerializationCache();
         frags.erase(fromAddress);
 
         return true;
@@ -301,6 +300,7 @@ bool Loom_LoRa::handleFragBody(JsonDocument &workingDoc,
 bool Loom_LoRa::handleSingleFrag(JsonDocument &workingDoc) {
     // overwrite the manager document by deep-copying the finalized packet
     manager->getDocument().set(workingDoc);
+    manager->clearSerializationCache();
     
     return true;
 }
@@ -343,16 +343,23 @@ bool Loom_LoRa::receive(uint timeout, bool shouldProxy) {
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 bool Loom_LoRa::transmitToLoRa(JsonObject json, uint8_t destinationAddress) {
     uint8_t buffer[MAX_MESSAGE_LENGTH] = {};
-    bool status = false;
 
-    status = serializeMsgPack(json, buffer, MAX_MESSAGE_LENGTH);
-    if (!status) {
+    size_t length = serializeMsgPack(json, buffer, MAX_MESSAGE_LENGTH);
+    if (!length) {
         ERROR(F("Failed to convert JSON to MsgPack"));
         return false;
     }
 
-    status = radioManager->sendtoWait(buffer, sizeof(buffer), 
-                                      destinationAddress);
+    return transmitBufferToLoRa(buffer, length, destinationAddress);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_LoRa::transmitBufferToLoRa(const uint8_t *buffer, size_t length, 
+                                     uint8_t destinationAddress) {
+    // the receiver zeroes its buffer first so only the used bytes need to go over the air
+    bool status = radioManager->sendtoWait((uint8_t *)buffer, length, 
+                                           destinationAddress);
     if (!status) {
         ERROR(F("Failed to send packet to specified address!"));
         return false;
@@ -437,6 +444,18 @@ bool Loom_LoRa::sendPacketHeader(JsonObject json,
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 bool Loom_LoRa::send(const uint8_t destinationAddress) {
+    if (!moduleInitialized) {
+        ERROR(F("Module not initialized!"));
+        return false;
+    }
+
+    // reuse the MsgPack the manager already produced this cycle if it fits in one packet
+    SerializedView packed = manager->getSerialized(FORMAT_MSGPACK);
+    if (packed.length > 0 && packed.length <= MAX_MESSAGE_LENGTH) {
+        return transmitBufferToLoRa((const uint8_t *)packed.data, packed.length,
+                                    destinationAddress);
+    }
+
     return send(destinationAddress, manager->getDocument().as<JsonObject>());
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -476,33 +495,31 @@ bool Loom_LoRa::sendBatch(const uint8_t destinationAddress) {
     }
 
     File fileOutput = batchSD->getBatch();
-    int batchSize = batchSD->getBatchSize();
+
+    // With an upload policy the batch may have grown past the batch size while uploads were deferred
+    int batchSize = batchSD->getCurrentBatch();
+    bool allSent = true;
 
     for (int i = 0; i < batchSize && fileOutput.available(); i++) {
-        uint8_t packetBuf[2000];
-        // read line from file into packetBuf
-        int len = fileOutput.readBytesUntil('\n', packetBuf, 
-                                            sizeof(packetBuf));
+        // deserialize the next packet straight from the file into the main 
+        // document, the line endings between packets are skipped as whitespace
+        auto err = deserializeJson(manager->getDocument(), fileOutput);
+        manager->clearSerializationCache();
 
-        if (!len) {
-            WARNING(F("BatchSD data missing ending newline"));
+        if (err == DeserializationError::EmptyInput) {
+            break;
+        } else if (err != DeserializationError::Ok) {
+            ERRORF("Error occurred parsing BatchSD packet: %s", err.c_str());
+            allSent = false;
             break;
         }
 
-        // remove trailing carriage return if DOS line endings have been used
-        if (packetBuf[len - 1] == '\r') {
-            packetBuf[len - 1] = 0;
-        }
-
-        // deserialze packet into main document
-        deserializeJson(manager->getDocument(), (const char *)packetBuf,
-                        sizeof(packetBuf));
-
         status = send(destinationAddress);
         if (status) {
             LOGF("Successfully transmitted packet (%i/%i)", i+1, batchSize);
         } else {
             ERRORF("Failed to transmit packet (%i/%i)", i+1, batchSize);
+            allSent = false;
         }
 
         delay(500);
@@ -511,6 +528,11 @@ bool Loom_LoRa::sendBatch(const uint8_t destinationAddress) {
     }
 
     fileOutput.close();
+
+    if (allSent)
+        batchSD->markPublished();
+
+    return allSent;
 }
 
 bool Loom_LoRa::receiveBatch(uint timeout, int* numberOfPackets) {
@@ -98,6 +98,12 @@ public:
      */ 
     void package() override;
 
+    /**
+     * Received packets replace the contents of the manager document, so it needs to
+     * be able to hold a full packet from any device
+     */ 
+    size_t getReceiveSize() override { return MAX_JSON_SIZE; };
+
     /**
      * Get this device's address
      */ 
@@ -213,6 +219,10 @@ private:
     // transmits a json document to over lora
     bool transmitToLoRa(JsonObject json, uint8_t destinationAddress);
 
+    // transmits an already serialized MsgPack packet over lora
+    bool transmitBufferToLoRa(const uint8_t *buffer, size_t length, 
+                              uint8_t destinationAddress);
+
     // returns whether sending was successful
     bool sendFullPacket(JsonObject json, uint8_t destinationAddress);
     bool sendFragmentedPacket(JsonObject json, uint8_t destinationAddress);
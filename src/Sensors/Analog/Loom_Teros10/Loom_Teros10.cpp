@@ -6,6 +6,9 @@ Loom_Teros10::Loom_Teros10(Manager& man, int port) : Module("Teros10"), manInst(
 
     // Set the module address in-case we have more than one Teros 10 on a single device
     module_address = port;
+    addSampleField("Millivolt_Reading", &milliVolt);
+    addSampleField("Dielectric_Permittivity", &dielecPerm);
+    addSampleField("Volumetric_Water_Content_%Vol", &volumetricWater);
     
     manInst->registerModule(this);
 }
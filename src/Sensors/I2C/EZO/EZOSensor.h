@@ -3,22 +3,71 @@
 #include <Wire.h>
 
 #include "../I2CDevice.h"
+#include "Loom_I2CBus.h"
 #include "Logger.h"
 
+#define EZO_RESPONSE_SIZE 32                // Bytes read back from the device, the response code followed by the null terminated reading
+
 class EZOSensor : public I2CDevice{
     public:
 
-        /* Construct a new EZO device */
-        EZOSensor(const char* modName) : I2CDevice(modName) {};
+        /**
+         * Construct a new EZO device
+         * @param modName Name of the module
+         * @param readTime Time in milliseconds the device takes to take a reading after it is requested
+         */
+        EZOSensor(const char* modName, int readTime = 1000) : I2CDevice(modName), readTime(readTime) {};
+
+        /* Make sure the bus lets go of the response buffer */
+        ~EZOSensor() { Loom_I2CBus::getInstance()->cancel(readTransaction); };
+
+        /* Split measurement so the manager can do other work while the device takes its reading */
+        void startMeasurement() override {
+            if(moduleInitialized){
+                readPending = requestRead();
+                readSubmitted = false;
+                if(!readPending)
+                    ERROR(F("Failed to send 'read' command to device"));
+            }
+        };
+
+        bool isMeasurementReady() override {
+            if(!readPending)
+                return true;
+            if(millis() - readRequestTime < readTime)
+                return false;
+
+            // The device has its reading, queue the response and let everything else run while it comes back
+            if(!readSubmitted)
+                submitRead();
+            return readTransaction.status != I2C_STATUS::QUEUED && readTransaction.status != I2C_STATUS::ACTIVE;
+        };
+
+        void collectMeasurement() override {
+            if(readPending){
+                readPending = false;
+                if(!readSubmitted)
+                    submitRead();
+
+                Loom_I2CBus::getInstance()->wait(readTransaction);
+                if(!readSucceeded){
+                    ERROR(F("Failed to read sensor!"));
+                    return;
+                }
+
+                // Parse the constructed string
+                parseReading(getSensorData());
+            }
+        };
+
+        uint32_t getConversionTime() override { return readTime; };
+
+        void measure() override { runMeasurement(); };
 
         
         /* General command to transmit data over I2C to the given device*/
         bool sendTransmission(const char* command){
-            Wire.beginTransmission(module_address);
-            Wire.write(command);
-
-            // Use a ternary operator to ensure if it is 0 its true if not we are false
-            return Wire.endTransmission() == 0;
+            return Loom_I2CBus::getInstance()->write(module_address, (const uint8_t*)command, strlen(command));
         };
 
         /* Calibrate The Device */
@@ -46,14 +95,9 @@ class EZOSensor : public I2CDevice{
          * @return Whether or not the read was successfully
          * */
         bool readSensor(int waitTime){
-            char output[OUTPUT_SIZE];
-            int i;
             if(moduleInitialized){
-                // Clear the sensorData received previously
-                memset(sensorData, '\0', 32);
-
                 // Attempt to send a read command to the device
-                if(!sendTransmission("r")){
+                if(!requestRead()){
                     ERROR(F("Failed to send 'read' command to device"));
                     return false;
                 }
@@ -61,28 +105,9 @@ class EZOSensor : public I2CDevice{
                 // Wait the desired warm-up period
                 delay(waitTime);
 
-                // Request 32 bytes of data from the device
-                Wire.requestFrom(module_address, 32, 1);
-
-                // Check if the I2C code was not valid
-                code = Wire.read();
-                
-                if(code != 1){
-                    snprintf(output, OUTPUT_SIZE, "Unsuccessful Response Code Received: %s", responseCodes[code-1]);
-                    ERROR(output);
-                    return false;
-                }
-
-                // Read out only the next 32 bytes
-                for(i = 0; i < 32; i++){
-                    currentChar = (char)Wire.read();
-                    // If a null char was received break out of the loop
-                    if(currentChar == '\0') break;
-
-                    // If not append the current char to the string
-                    strncat(sensorData, &currentChar, 32);
-                }
-                strncat(sensorData, "\0", 32);
+                submitRead();
+                Loom_I2CBus::getInstance()->wait(readTransaction);
+                return readSucceeded;
             }
 
             return true;
@@ -90,11 +115,85 @@ class EZOSensor : public I2CDevice{
 
         /* Get the most recently collected sensor data */
         const char* getSensorData() { return sensorData; };
+
+    protected:
+
+        /**
+         * Called with the response once a reading has been collected
+         * @param data Null terminated response from the device
+         */
+        virtual void parseReading(const char* data) = 0;
     
     private:
-        int8_t code = 0;                                                            // I2C Response Code
-        char currentChar;                                                           // Current character we have read in
-        const char* responseCodes[4] = {"Success", "Failed", "Pending", "No Data"}; // Stringified I2C Response codes
+
+        /* Ask the device to start taking a reading */
+        bool requestRead(){
+            // Clear the sensorData received previously
+            memset(sensorData, '\0', sizeof(sensorData));
+            readRequestTime = millis();
+            return sendTransmission("r");
+        };
+
+        /* Queue a read of the response to the last read request, finishRead() checks it once it arrives */
+        void submitRead(){
+            readSubmitted = true;
+            readSucceeded = false;
+
+            readTransaction = I2CTransaction();
+            readTransaction.address = module_address;
+            readTransaction.readData = response;
+            readTransaction.readLength = EZO_RESPONSE_SIZE;
+            readTransaction.onComplete = readComplete;
+            readTransaction.context = this;
+            Loom_I2CBus::getInstance()->submit(readTransaction);
+        };
+
+        /* Called by the bus once the response has been read */
+        static void readComplete(I2CTransaction& transaction, void* context){
+            ((EZOSensor*)context)->finishRead(transaction.status == I2C_STATUS::DONE);
+        };
+
+        /* Check the response code and pull the reading out of the response */
+        void finishRead(bool received){
+            char output[OUTPUT_SIZE];
+            if(!received){
+                ERROR(F("No response received from the device"));
+                return;
+            }
+
+            // Check if the I2C code was not valid
+            code = response[0];
+            if(code != 1){
+                snprintf(output, OUTPUT_SIZE, "Unsuccessful Response Code Received: %s", responseCodeName(code));
+                ERROR(output);
+                return;
+            }
+
+            // The reading follows the code and is null terminated unless it fills the rest of the response
+            memcpy(sensorData, response + 1, EZO_RESPONSE_SIZE - 1);
+            sensorData[EZO_RESPONSE_SIZE - 1] = '\0';
+            readSucceeded = true;
+        };
+
+        /* Stringify the response code sent back by the device */
+        const char* responseCodeName(uint8_t responseCode){
+            switch(responseCode){
+                case 1:     return "Success";
+                case 2:     return "Failed";
+                case 254:   return "Pending";
+                case 255:   return "No Data";
+                default:    return "Unknown";
+            }
+        };
+
+        unsigned long readTime;                                                     // Time in milliseconds it takes the device to take a reading
+        unsigned long readRequestTime = 0;                                          // millis() when the last reading was requested
+        bool readPending = false;                                                   // Whether a reading has been requested but not collected
+        bool readSubmitted = false;                                                 // Whether the response has been queued on the bus
+        bool readSucceeded = false;                                                 // Whether the last response arrived with a success code
+        I2CTransaction readTransaction;                                             // Read of the response, owned here so it outlives the call that queued it
+        uint8_t response[EZO_RESPONSE_SIZE];                                        // Raw response from the device
+        uint8_t code = 0;                                                           // I2C Response Code
         char sensorData[33];                                                        // Convert the char array to a string to improve parse-ability
         
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Module.h"
+#include "Loom_I2CBus.h"
 #include "Logger.h"
 
 class I2CDevice : public Module{
@@ -13,8 +14,7 @@ class I2CDevice : public Module{
         bool checkDeviceConnection() {
             FUNCTION_START;
             if(module_address != -1){
-                Wire.beginTransmission(module_address);
-                if(Wire.endTransmission() == 0){
+                if(Loom_I2CBus::getInstance()->probe(module_address)){
                     FUNCTION_END;
                     return true;
                 }
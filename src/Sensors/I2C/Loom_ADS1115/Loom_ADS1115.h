@@ -20,6 +20,7 @@ class Loom_ADS1115 : public I2CDevice{
         void initialize() override;
         void measure() override;
         void package() override;
+        size_t getPackageSize() override { return MODULE_PACKAGE_SIZE(10); };
         void power_up() override;
 
         /**
@@ -20,6 +20,7 @@ class Loom_AS7263 : public I2CDevice{
         void measure() override;                               
         void initialize() override;    
         void package() override;   
+        size_t getPackageSize() override { return MODULE_PACKAGE_SIZE(6); };
         void power_up() override;
 
     public:
@@ -21,6 +21,7 @@ class Loom_AS7265X : public I2CDevice{
         void measure() override;                               
         void initialize() override;    
         void package() override;   
+        size_t getPackageSize() override { return MODULE_PACKAGE_SIZE(18); };
         void power_up() override;
 
     public:
@@ -4,6 +4,7 @@
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 Loom_DFRobotO2::Loom_DFRobotO2(Manager& man, bool useMux, int address, int collectNum) : I2CDevice("DFRobotO2"), manInst(&man), collectNumber(collectNum){ 
     module_address = address;
+    addSampleField("Oxygen Concentration_%Vol", &oxygenConcentration);
     if(!useMux)
         manInst->registerModule(this); 
 }
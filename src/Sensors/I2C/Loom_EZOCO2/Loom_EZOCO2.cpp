@@ -1,7 +1,7 @@
 #include "Loom_EZOCO2.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Loom_EZOCO2::Loom_EZOCO2(Manager& man, byte address, bool useMux) : EZOSensor("EZO-CO2"), manInst(&man){
+Loom_EZOCO2::Loom_EZOCO2(Manager& man, byte address, bool useMux) : EZOSensor("EZO-CO2", 1000), manInst(&man){
     module_address = address;
 
     if(!useMux)
@@ -17,14 +17,9 @@ void Loom_EZOCO2::initialize(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-void Loom_EZOCO2::measure(){
-    if(moduleInitialized){
-        if(!readSensor(1000)){
-            ERROR(F("Failed to read sensor!"));
-            return;
-        }
-        co2 = atof(getSensorData());
-    }
+void Loom_EZOCO2::parseReading(const char* data){
+    // Parse the constructed string
+    co2 = atof(data);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
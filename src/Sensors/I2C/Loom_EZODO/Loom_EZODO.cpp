@@ -1,8 +1,10 @@
 #include "Loom_EZODO.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Loom_EZODO::Loom_EZODO(Manager& man, byte address, bool useMux) : EZOSensor("EZO-DO"), manInst(&man){
+Loom_EZODO::Loom_EZODO(Manager& man, byte address, bool useMux) : EZOSensor("EZO-DO", 700), manInst(&man){
     module_address = address;
+    addSampleField("D-Ox_mg/L", &oxygen);
+    addSampleField("Sat_%", &saturation);
 
     if(!useMux)
         manInst->registerModule(this);
@@ -16,18 +18,9 @@ void Loom_EZODO::initialize(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-void Loom_EZODO::measure(){
-    if(moduleInitialized){
-
-        // Attempt to read data from the sensor
-        if(!readSensor(700)){
-            ERROR(F("Failed to read sensor!"));
-            return;
-        }
-
-        // Parse the constructed string
-        parseResponse(getSensorData());
-    }
+void Loom_EZODO::parseReading(const char* data){
+    // Parse the constructed string
+    parseResponse(data);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -1,8 +1,9 @@
 #include "Loom_EZOORP.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Loom_EZOORP::Loom_EZOORP(Manager& man, byte address, bool useMux) : EZOSensor("EZO-ORP"), manInst(&man){
+Loom_EZOORP::Loom_EZOORP(Manager& man, byte address, bool useMux) : EZOSensor("EZO-ORP", 1000), manInst(&man){
     module_address = address;
+    addSampleField("ORP_mV", &orp);
 
     if(!useMux)
         manInst->registerModule(this);
@@ -16,18 +17,9 @@ void Loom_EZOORP::initialize(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-void Loom_EZOORP::measure(){
-    if(moduleInitialized){
-
-        // Attempt to read data from the sensor
-        if(!readSensor(1000)){
-            ERROR(F("Failed to read sensor!"));
-            return;
-        }
-
-        // Parse the constructed string
-        orp = atof(getSensorData());
-    }
+void Loom_EZOORP::parseReading(const char* data){
+    // Parse the constructed string
+    orp = atof(data);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
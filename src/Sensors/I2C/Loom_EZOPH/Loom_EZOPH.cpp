@@ -1,8 +1,9 @@
 #include "Loom_EZOPH.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Loom_EZOPH::Loom_EZOPH(Manager& man, byte address, bool useMux) : EZOSensor("EZO-PH"), manInst(&man){
+Loom_EZOPH::Loom_EZOPH(Manager& man, byte address, bool useMux) : EZOSensor("EZO-PH", 1000), manInst(&man){
     module_address = address;
+    addSampleField("PH", &ph);
 
     if(!useMux)
         manInst->registerModule(this);
@@ -16,18 +17,9 @@ void Loom_EZOPH::initialize(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-void Loom_EZOPH::measure(){
-    if(moduleInitialized){
-
-        // Attempt to read data from the sensor
-        if(!readSensor(1000)){
-            ERROR(F("Failed to read sensor!"));
-            return;
-        }
-
-        // Parse the constructed string
-        ph = atof(getSensorData());  
-    }
+void Loom_EZOPH::parseReading(const char* data){
+    // Parse the constructed string
+    ph = atof(data);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
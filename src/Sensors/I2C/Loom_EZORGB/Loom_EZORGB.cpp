@@ -1,7 +1,7 @@
 #include "Loom_EZORGB.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Loom_EZORGB::Loom_EZORGB(Manager& man, byte address, bool useMux) : EZOSensor("EZO-RGB"), manInst(&man){
+Loom_EZORGB::Loom_EZORGB(Manager& man, byte address, bool useMux) : EZOSensor("EZO-RGB", 400), manInst(&man){
     module_address = address;
 
     if(!useMux)
@@ -16,18 +16,9 @@ void Loom_EZORGB::initialize(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-void Loom_EZORGB::measure(){
-    if(moduleInitialized){
-
-        // Attempt to read data from the sensor
-        if(!readSensor(400)){
-            ERROR(F("Failed to read sensor!"));
-            return;
-        }
-
-        // Parse the constructed string
-        parseData(getSensorData());
-    }
+void Loom_EZORGB::parseReading(const char* data){
+    // Parse the constructed string
+    parseData(data);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
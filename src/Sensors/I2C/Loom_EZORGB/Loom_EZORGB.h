@@ -12,10 +12,10 @@ class Loom_EZORGB : public EZOSensor{
     protected:
         
         void power_up() override {}; 
+        void parseReading(const char* data) override;               // Store the values from the reading
 
     public:
         void initialize() override;
-        void measure() override;
         void package() override;
         void power_down() override;
 
@@ -78,22 +78,19 @@ bool Loom_K30::verifyChecksum(){
 ///////////////////////////////////////////////////////////////////////////////
 void Loom_K30::getCO2Level() {
     // Send the request for data
-    Wire.beginTransmission(addr);
-    Wire.write(0x22);
-    Wire.write(0x00);
-    Wire.write(0x08);
-    Wire.write(0x2A);
-    Wire.endTransmission();
+    const uint8_t request[4] = {0x22, 0x00, 0x08, 0x2A};
+    if(!Loom_I2CBus::getInstance()->write(addr, request, 4)){
+        ERROR(F("Failed to send the read request! Using previously recorded data."));
+        return;
+    }
 
     // Wait to ensure data is properly recorded
-    delay(10);
+    Loom_Executor::getInstance()->wait(10);
 
     // Request 4 bytes of data from the sensor
-    Wire.requestFrom(addr, 4);
-
-    // Read the data from the wire
-    for(int i = 0; i < 4; i++){
-        buffer[i] = Wire.read();
+    if(!Loom_I2CBus::getInstance()->read(addr, buffer, 4)){
+        ERROR(F("Failed to read the response! Using previously recorded data."));
+        return;
     }
 
     // Make sure the data is correct
@@ -5,6 +5,7 @@
 
 #include "Loom_Manager.h"
 #include "../I2CDevice.h"
+#include "Loom_I2CBus.h"
 
 
 /**
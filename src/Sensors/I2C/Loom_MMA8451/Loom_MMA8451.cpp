@@ -70,6 +70,13 @@ void Loom_MMA8451::measure() {
             ERROR(F("No acknowledge received from the device"));
             return;
         }
+
+        // Summarize a burst of samples rather than taking a single reading
+        if(burstMode){
+            uint16_t count = captureBurst();
+            computeVibrationFeatures(burst, count, vibrationCountsPerG(4096 >> range, burstAxis), MMA8451_BURST_RATE, features);
+            return;
+        }
         
         
         // Update the sensor
@@ -95,6 +102,13 @@ void Loom_MMA8451::package() {
     char orientationString[25];
     if(moduleInitialized){
         JsonObject json = manInst->get_data_object(getModuleName());
+
+        // Only the summary is sent in burst mode
+        if(burstMode){
+            packageVibrationFeatures(json, features);
+            return;
+        }
+
         json["X_Acc_g"] = accel[2];
         json["Y_Acc_g"] = accel[0];
         json["Z_Acc_g"] = accel[1];
@@ -117,6 +131,52 @@ void Loom_MMA8451::package() {
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint16_t Loom_MMA8451::captureBurst(){
+    uint16_t count = 0;
+    uint8_t ctrl = mma.readRegister8(MMA8451_REG_CTRL_REG1);
+
+    // The FIFO and the data rate can only be changed in standby
+    mma.writeRegister8(MMA8451_REG_CTRL_REG1, ctrl & ~0x01);
+    mma.writeRegister8(MMA8451_REG_F_SETUP, MMA8451_FIFO_CIRCULAR);
+    mma.writeRegister8(MMA8451_REG_CTRL_REG1, (ctrl & ~MMA8451_DATARATE_BITS) | 0x01);
+
+    unsigned long timeout = BURST_SAMPLES * 1000UL / MMA8451_BURST_RATE + BURST_TIMEOUT_MARGIN;
+    unsigned long startTime = millis();
+    while(count < BURST_SAMPLES && millis() - startTime < timeout){
+        uint8_t available = mma.readRegister8(MMA8451_REG_F_STATUS) & MMA8451_FIFO_COUNT;
+        available = min(min(available, (uint8_t)BURST_CHUNK_SAMPLES), (uint8_t)(BURST_SAMPLES - count));
+        if(available == 0)
+            continue;
+
+        // With the FIFO on the address wraps back to X after Z so consecutive samples can be read in one go
+        Wire.beginTransmission(address);
+        Wire.write(MMA8451_REG_OUT_X_MSB);
+        Wire.endTransmission(false);
+        Wire.requestFrom(address, available * 6);
+
+        for(int i = 0; i < available; i++){
+            int16_t axes[3];
+            for(int j = 0; j < 3; j++){
+                uint8_t msb = Wire.read();
+                uint8_t lsb = Wire.read();
+                axes[j] = (int16_t)((msb << 8) | lsb) >> 2;     // 14 bit left aligned
+            }
+            burst[count++] = selectVibrationAxis(axes[0], axes[1], axes[2], burstAxis);
+        }
+    }
+
+    // Put the sensor back how single readings expect it
+    mma.writeRegister8(MMA8451_REG_CTRL_REG1, ctrl & ~0x01);
+    mma.writeRegister8(MMA8451_REG_F_SETUP, 0x00);
+    mma.writeRegister8(MMA8451_REG_CTRL_REG1, ctrl);
+
+    if(count < BURST_SAMPLES)
+        WARNINGF("Burst timed out after %i of %i samples", count, BURST_SAMPLES);
+    return count;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_MMA8451::power_up() {
     if(moduleInitialized){
@@ -4,6 +4,7 @@
 #include <Adafruit_MMA8451.h>
 
 #include "../I2CDevice.h"
+#include "../VibrationAnalysis.h"
 #include "Loom_Manager.h"
 
 // Consult the datasheet for MMA8451 to change these values
@@ -19,6 +20,13 @@
 #define MMA8451_REG_TRANSIENT_THS 0x1F
 #define MMA8451_REG_TRANSIENT_CT  0x20
 #define MMA8451_REG_TRANSIENT_SRC 0x1E
+#define MMA8451_REG_F_STATUS 0x00
+#define MMA8451_REG_F_SETUP 0x09
+
+#define MMA8451_FIFO_CIRCULAR 0b01000000    // F_SETUP value for a circular FIFO, 0 turns the FIFO off
+#define MMA8451_FIFO_COUNT 0b00111111       // Mask for the number of samples in the FIFO in F_STATUS
+#define MMA8451_DATARATE_BITS 0b00111000    // Output data rate bits in CTRL_REG1, all zero is 800Hz
+#define MMA8451_BURST_RATE 800.0            // Highest output data rate in Hz
 
 // Used to pass along the user defined interrupt callback
 using InterruptCallbackFunction = void (*)();
@@ -80,6 +88,20 @@ class Loom_MMA8451 : public I2CDevice{
         */
         void setISR(InterruptCallbackFunction isr) { this->isr = isr; };
 
+        /**
+         * Instead of a single reading, drain a burst of BURST_SAMPLES from the FIFO at 800Hz on each measure and only package the vibration features (RMS, peak, crest factor and band energies)
+         * @param enable Whether or not to use burst mode
+         * @param axis Which axis the features are computed on
+         */
+        void setBurstMode(bool enable, VIBRATION_AXIS axis = VIBRATION_AXIS::MAGNITUDE) { burstMode = enable; burstAxis = axis; };
+
+        /**
+         * Get the features from the last burst
+         */
+        const VibrationFeatures& getVibrationFeatures() { return features; };
+
+        size_t getPackageSize() override { return MODULE_PACKAGE_SIZE(burstMode ? VIBRATION_PACKAGE_FIELDS : DEFAULT_PACKAGE_FIELDS); };
+
         static void IMU_ISR();
 
 
@@ -97,4 +119,12 @@ class Loom_MMA8451 : public I2CDevice{
 
         float			accel[3];		        // Acceleration values for each axis. Units: g
 	    uint8_t			orientation;	        // Orientation
+
+        /* Burst mode */
+        bool burstMode = false;                 // Capture a burst and package the features instead of a single reading
+        VIBRATION_AXIS burstAxis = VIBRATION_AXIS::MAGNITUDE;  // Axis the features are computed on
+        int16_t burst[BURST_SAMPLES];           // Raw samples from the last burst
+        VibrationFeatures features;             // Features computed from the last burst
+
+        uint16_t captureBurst();                // Fill the burst buffer from the FIFO, returns the number of samples captured
 };
\ No newline at end of file
@@ -35,6 +35,13 @@ Should add to issues to fix in the future.
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_MPU6050::measure(){
 
+    // Summarize a burst of samples rather than taking a single reading
+    if(burstMode){
+        uint16_t count = captureBurst();
+        computeVibrationFeatures(burst, count, vibrationCountsPerG(MPU6050_COUNTS_PER_G, burstAxis), MPU6050_BURST_RATE, features);
+        return;
+    }
+
     // Pull new data from the sensor
     mpu.update();
 
@@ -60,6 +67,12 @@ void Loom_MPU6050::measure(){
 void Loom_MPU6050::package(){
     JsonObject json = manInst->get_data_object(getModuleName());
 
+    // Only the summary is sent in burst mode
+    if(burstMode){
+        packageVibrationFeatures(json, features);
+        return;
+    }
+
     // Acceleration
     json["ax_g"] = acc[0];
     json["ay_g"] = acc[1];
@@ -84,4 +97,52 @@ void Loom_MPU6050::calibrate(){
     mpu.calcGyroOffsets(true);
     Serial.println();
 }
-//////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint16_t Loom_MPU6050::captureBurst(){
+    uint16_t count = 0;
+
+    // Sample at 1kHz behind the low pass filter and only queue the accelerometer
+    mpu.writeMPU6050(MPU6050_CONFIG, MPU6050_BURST_DLPF);
+    mpu.writeMPU6050(MPU6050_SMPLRT_DIV, 0x00);
+    mpu.writeMPU6050(MPU6050_REG_USER_CTRL, MPU6050_FIFO_RESET);
+    mpu.writeMPU6050(MPU6050_REG_USER_CTRL, MPU6050_FIFO_ENABLE);
+    mpu.writeMPU6050(MPU6050_REG_FIFO_EN, MPU6050_FIFO_ACCEL);
+
+    unsigned long timeout = BURST_SAMPLES * 1000UL / MPU6050_BURST_RATE + BURST_TIMEOUT_MARGIN;
+    unsigned long startTime = millis();
+    while(count < BURST_SAMPLES && millis() - startTime < timeout){
+        uint16_t bytes = (mpu.readMPU6050(MPU6050_REG_FIFO_COUNTH) << 8) | mpu.readMPU6050(MPU6050_REG_FIFO_COUNTL);
+        uint8_t available = min(min(bytes / 6, BURST_CHUNK_SAMPLES), BURST_SAMPLES - count);
+        if(available == 0)
+            continue;
+
+        // Reading the FIFO register repeatedly pops the next byte
+        Wire.beginTransmission(MPU6050_ADDR);
+        Wire.write(MPU6050_REG_FIFO_R_W);
+        Wire.endTransmission(false);
+        Wire.requestFrom(MPU6050_ADDR, available * 6);
+
+        for(int i = 0; i < available; i++){
+            int16_t axes[3];
+            for(int j = 0; j < 3; j++){
+                uint8_t msb = Wire.read();
+                uint8_t lsb = Wire.read();
+                axes[j] = (int16_t)((msb << 8) | lsb);
+            }
+            burst[count++] = selectVibrationAxis(axes[0], axes[1], axes[2], burstAxis);
+        }
+    }
+
+    // Put the sensor back how the library set it up
+    mpu.writeMPU6050(MPU6050_REG_FIFO_EN, 0x00);
+    mpu.writeMPU6050(MPU6050_REG_USER_CTRL, MPU6050_FIFO_RESET);
+    mpu.writeMPU6050(MPU6050_CONFIG, 0x00);
+    mpu.writeMPU6050(MPU6050_SMPLRT_DIV, 0x00);
+
+    if(count < BURST_SAMPLES)
+        WARNINGF("Burst timed out after %i of %i samples", count, BURST_SAMPLES);
+    return count;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1,11 +1,26 @@
 #pragma once
 
 #include "../I2CDevice.h"
+#include "../VibrationAnalysis.h"
 #include "Loom_Manager.h"
 
 #include <Wire.h>
 #include <MPU6050_tockn.h>
 
+// Register Addresses
+#define MPU6050_REG_FIFO_EN 0x23
+#define MPU6050_REG_USER_CTRL 0x6A
+#define MPU6050_REG_FIFO_COUNTH 0x72
+#define MPU6050_REG_FIFO_COUNTL 0x73
+#define MPU6050_REG_FIFO_R_W 0x74
+
+#define MPU6050_FIFO_ACCEL 0b00001000       // FIFO_EN value to only put the accelerometer in the FIFO
+#define MPU6050_FIFO_ENABLE 0b01000000      // USER_CTRL bit to turn the FIFO on
+#define MPU6050_FIFO_RESET 0b00000100       // USER_CTRL bit to empty the FIFO
+#define MPU6050_BURST_DLPF 0x01             // CONFIG value for the 184Hz low pass filter, this also drops the sample clock to 1kHz
+#define MPU6050_BURST_RATE 1000.0           // Highest accelerometer output rate in Hz
+#define MPU6050_COUNTS_PER_G 16384.0        // Counts per g at the +-2g range the library sets
+
 /**
  *  MPU6050 Accelerometer / IMU
  * 
@@ -23,12 +38,25 @@ class Loom_MPU6050 : public I2CDevice{
         void initialize() override;
         void measure() override;
         void package() override;
+        size_t getPackageSize() override { return MODULE_PACKAGE_SIZE(burstMode ? VIBRATION_PACKAGE_FIELDS : 9); };
 
         /**
          * Manually re-calibrate the gyro
          */ 
         void calibrate();
 
+        /**
+         * Instead of a single reading, drain a burst of BURST_SAMPLES accelerometer readings from the FIFO at 1kHz on each measure and only package the vibration features (RMS, peak, crest factor and band energies)
+         * @param enable Whether or not to use burst mode
+         * @param axis Which axis the features are computed on
+         */
+        void setBurstMode(bool enable, VIBRATION_AXIS axis = VIBRATION_AXIS::MAGNITUDE) { burstMode = enable; burstAxis = axis; };
+
+        /**
+         * Get the features from the last burst
+         */
+        const VibrationFeatures& getVibrationFeatures() { return features; };
+
     private:
         Manager* manInst;       // Instance of the manager
         MPU6050 mpu;            // Instance of the MPU sensor library
@@ -37,4 +65,12 @@ class Loom_MPU6050 : public I2CDevice{
         float acc[3];           // Acceleration of the gyroscope
         float rate[3];          // Rate of rotation in degrees/second
         float angle[3];         // Angle of the gyroscope
+
+        /* Burst mode */
+        bool burstMode = false;                                 // Capture a burst and package the features instead of a single reading
+        VIBRATION_AXIS burstAxis = VIBRATION_AXIS::MAGNITUDE;   // Axis the features are computed on
+        int16_t burst[BURST_SAMPLES];                           // Raw samples from the last burst
+        VibrationFeatures features;                             // Features computed from the last burst
+
+        uint16_t captureBurst();                                // Fill the burst buffer from the FIFO, returns the number of samples captured
 };
\ No newline at end of file
@@ -4,6 +4,8 @@
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 Loom_MS5803::Loom_MS5803(Manager& man, byte address, bool useMux) : I2CDevice("MS5803"), manInst(&man), inst(address, 512) {
     module_address = address;
+    addSampleField("Temperature_°C", &sensorData[0]);
+    addSampleField("Pressure_mbar", &sensorData[1]);
 
     if(!useMux)
         manInst->registerModule(this);
@@ -45,72 +45,108 @@ void Loom_SEN55::initialize() {
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-void Loom_SEN55::measure() {
+void Loom_SEN55::startMeasurement() {
     FUNCTION_START;
-    char output[OUTPUT_SIZE];
-    char sensorError[OUTPUT_SIZE];
 
-    delay(100);
     // Reset the relevent values for the average calcuation of the PM measurements
     resetValuesForMeasure();
+    pmSamplesTaken = 0;
+    failedReads = 0;
+    dataReady = false;
+    measurementReady = false;
 
     // Turn on pm reading if needed
     if(measurePM){
         LOG(F("Beginning PM measurement, waiting 2 seconds at each increment for stablizing mesurement..."));
-        uint16_t readErr = sen5x.startMeasurement();
-        float Pm1p0 = 0, Pm2p5 = 0, Pm4p0 = 0, Pm10p0 = 0;
-        float numPm0p5 = 0, numPm1p0 = 0, numPm2p5 = 0, numPm4p0 = 0, numPm10p0 = 0;
-        float particleSize = 0;
-        uint8_t failedReads = 0;
-        for(int i = 0; i < PM_AVERAGE_COUNT; i++){
-            delay(2000);
-
-            bool dataReady = false;
-            sen5x.readDataReady(dataReady);
-            if(!dataReady && i == 0){
-                uint16_t startTime = millis();
-                LOG(F("No data available on iteration 0, waiting an additional 5 seconds to see if data becomes available"));
-                while(!dataReady && millis() < startTime + 5000){
-                    sen5x.readDataReady(dataReady);
-                }
-            }
+        sen5x.startMeasurement();
+        nextReadTime = millis() + PM_SAMPLE_INTERVAL;
 
-            if(dataReady)
-                sen5x.readMeasuredPmValues(Pm1p0, Pm2p5, Pm4p0, Pm10p0, numPm0p5, numPm1p0,
-                                        numPm2p5, numPm4p0, numPm10p0, particleSize);
-            else{
-                failedReads++;
-            }
+        // If there is no data on the first sample we wait a little extra to see if it becomes available
+        readDeadline = nextReadTime + PM_FIRST_SAMPLE_WAIT;
+    }
+    else {
+        LOG("Beginning measurement without PM, waiting 10 seconds for sensor to stabilize...");
+        sen5x.startMeasurementWithoutPm();
+        nextReadTime = millis() + WARMUP_TIME;
+        readDeadline = nextReadTime + DATA_READY_TIMEOUT;
+    }
 
-            massConcentrationPm1p0 += Pm1p0;
-            massConcentrationPm2p5 += Pm2p5;
-            massConcentrationPm4p0 += Pm4p0;
-            massConcentrationPm10p0 += Pm10p0;
-            if(readNumVals){
-                numConcentrationPm0p5 += numPm0p5;
-                numConcentrationPm1p0 += numPm1p0;
-                numConcentrationPm2p5 += numPm2p5;
-                numConcentrationPm4p0 += numPm4p0;
-                numConcentrationPm10p0 += numPm10p0;
-                typicalParticleSize += particleSize;
-            }
-            delay(1);
-        }
+    FUNCTION_END;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_SEN55::isMeasurementReady() {
+    if(measurementReady)
+        return true;
+
+    // Still stabilizing
+    if((long)(millis() - nextReadTime) < 0)
+        return false;
+
+    sen5x.readDataReady(dataReady);
+
+    // Keep checking until the data is ready or we run out of time
+    if(!dataReady && (long)(millis() - readDeadline) < 0)
+        return false;
+
+    if(measurePM){
+        addPMSample();
+
+        // Only the first sample gets extra time to become ready
+        nextReadTime = millis() + PM_SAMPLE_INTERVAL;
+        readDeadline = nextReadTime;
+        measurementReady = pmSamplesTaken >= PM_AVERAGE_COUNT;
+    }
+    else{
+        measurementReady = true;
+    }
+
+    return measurementReady;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_SEN55::addPMSample() {
+    float values[PM_VALUES] = {0};
+
+    pmSamplesTaken++;
+    if(!dataReady){
+        failedReads++;
+        return;
+    }
+
+    sen5x.readMeasuredPmValues(values[0], values[1], values[2], values[3], values[4], values[5],
+                            values[6], values[7], values[8], values[9]);
+
+    // The number concentrations and particle size are only kept if readNumVals is set
+    uint8_t count = readNumVals ? PM_VALUES : 4;
+    for(int i = 0; i < count; i++)
+        pmStats[i].add(values[i]);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_SEN55::collectMeasurement() {
+    FUNCTION_START;
+    char output[OUTPUT_SIZE];
+    char sensorError[OUTPUT_SIZE];
 
-        if(failedReads < PM_AVERAGE_COUNT){
-            // Calculate the average of the values (excluding failed reads)
-            massConcentrationPm1p0 /= (PM_AVERAGE_COUNT - failedReads);
-            massConcentrationPm2p5 /= (PM_AVERAGE_COUNT - failedReads);
-            massConcentrationPm4p0 /= (PM_AVERAGE_COUNT - failedReads);
-            massConcentrationPm10p0 /= (PM_AVERAGE_COUNT - failedReads);;
+    if(measurePM){
+        if(failedReads < pmSamplesTaken){
+            // Average of the values (excluding failed reads)
+            massConcentrationPm1p0 = pmStats[0].mean;
+            massConcentrationPm2p5 = pmStats[1].mean;
+            massConcentrationPm4p0 = pmStats[2].mean;
+            massConcentrationPm10p0 = pmStats[3].mean;
 
             if(readNumVals){
-                numConcentrationPm0p5 /= (PM_AVERAGE_COUNT - failedReads);;
-                numConcentrationPm1p0 /= (PM_AVERAGE_COUNT - failedReads);;
-                numConcentrationPm2p5 /= (PM_AVERAGE_COUNT - failedReads);;
-                numConcentrationPm4p0 /= (PM_AVERAGE_COUNT - failedReads);;
-                numConcentrationPm10p0 /= (PM_AVERAGE_COUNT - failedReads);;
-                typicalParticleSize /= (PM_AVERAGE_COUNT - failedReads);;
+                numConcentrationPm0p5 = pmStats[4].mean;
+                numConcentrationPm1p0 = pmStats[5].mean;
+                numConcentrationPm2p5 = pmStats[6].mean;
+                numConcentrationPm4p0 = pmStats[7].mean;
+                numConcentrationPm10p0 = pmStats[8].mean;
+                typicalParticleSize = pmStats[9].mean;
             }
         }
 
@@ -119,58 +155,39 @@ void Loom_SEN55::measure() {
         }
 
         float tmp = 0.0;
-        readErr = sen5x.readMeasuredValues(
-                                            tmp, tmp, tmp, tmp,
-                                            ambientHumidity, ambientTemperature, vocIndex,
-                                            noxIndex
-                                        );
+        sen5x.readMeasuredValues(
+                                    tmp, tmp, tmp, tmp,
+                                    ambientHumidity, ambientTemperature, vocIndex,
+                                    noxIndex
+                                );
 
-        readErr = sen5x.startMeasurementWithoutPm();
+        sen5x.startMeasurementWithoutPm();
         delay(60);
     }
 
-    else {
-        LOG("Beginning measurement without PM, waiting 10 seconds for sensor to stabilize...");
-        uint16_t readErr = sen5x.startMeasurementWithoutPm();
-        delay(10000);
-
-        uint16_t error = 0;
-        // Give the sensor time to prepare for measuring
-        bool dataReady = false;
-        uint16_t startTime = millis();
-        LOG(F("Waiting for data to be ready... If not ready in 10 seconds we will stop trying"));
-        while(!dataReady && millis() < startTime + 10000){
-            error = sen5x.readDataReady(dataReady);
-            if(error){
-                errorToString(error, sensorError, OUTPUT_SIZE);
-                snprintf(output, OUTPUT_SIZE, "Failed to check if data was ready to be read: %s", sensorError);
-                ERROR(output);
-            }
-        }
+    // If the data was not ready we don't want to update the sensor values
+    else if(dataReady){
+        LOG("Device was ready to read a new sample!");
+        float tmp = 0.0;
+        // Request the measured values form the sensor
+        uint16_t error = sen5x.readMeasuredValues(
+                                            tmp, tmp, tmp, tmp,
+                                            ambientHumidity, ambientTemperature, vocIndex,
+                                            noxIndex
+                                        );
 
-        // If the data was not ready we don't want to update the sensor values
-        if(dataReady){
-            LOG("Device was ready to read a new sample!");
-            float tmp = 0.0;
-            // Request the measured values form the sensor
-            error = sen5x.readMeasuredValues(
-                                                tmp, tmp, tmp, tmp,
-                                                ambientHumidity, ambientTemperature, vocIndex,
-                                                noxIndex
-                                            );
-
-            // Check if we had an error reading the sensor values
-            if(error){
-                errorToString(error, sensorError, OUTPUT_SIZE);
-                snprintf(output, OUTPUT_SIZE, "Error occurred when reading measurement: %s", sensorError);
-                ERROR(output);
-                FUNCTION_END;
-                return;
-            }
-        }else{
-            ERROR("No new data was ready within the given time period.");
+        // Check if we had an error reading the sensor values
+        if(error){
+            errorToString(error, sensorError, OUTPUT_SIZE);
+            snprintf(output, OUTPUT_SIZE, "Error occurred when reading measurement: %s", sensorError);
+            ERROR(output);
+            FUNCTION_END;
+            return;
         }
     }
+    else{
+        ERROR("No new data was ready within the given time period.");
+    }
 
     /* TODO: Implement this once we know the raw integration works.
     // Get the current connection status
@@ -281,6 +298,8 @@ void Loom_SEN55::resetValuesForMeasure() {
     numConcentrationPm4p0 = 0;
     numConcentrationPm10p0 = 0;
     typicalParticleSize = 0;
+    for(int i = 0; i < PM_VALUES; i++)
+        pmStats[i].reset();
     FUNCTION_END;
     return;
 }
\ No newline at end of file
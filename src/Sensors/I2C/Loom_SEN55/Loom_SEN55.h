@@ -8,6 +8,11 @@
 #include "Loom_Manager.h"
 
 #define PM_AVERAGE_COUNT 10     // Number of times to read the pm values then average them over
+#define PM_SAMPLE_INTERVAL 2000 // Time in milliseconds between each PM sample to let the measurement stabilize
+#define PM_FIRST_SAMPLE_WAIT 5000   // Additional time in milliseconds to wait for the first PM sample to become available
+#define WARMUP_TIME 10000       // Time in milliseconds to let the sensor stabilize when not measuring PM
+#define DATA_READY_TIMEOUT 10000    // Time in milliseconds to wait for data once the sensor has stabilized
+#define PM_VALUES 10            // Mass concentrations, number concentrations and typical particle size read with each PM sample
 
 /**
  *  SEN55 Air Quality sensors, supports pm 1.0, 2.5, 4.0, 10 as well as Temp/Humidity and Nox and Voc index
@@ -22,11 +27,17 @@ class Loom_SEN55 : public I2CDevice{
     protected:
 
        // Manager controlled functions
-        void measure() override;
+        void measure() override { runMeasurement(); };
         void initialize() override;
+
+        // Split measurement, the PM samples are taken while the manager polls isMeasurementReady
+        void startMeasurement() override;
+        bool isMeasurementReady() override;
+        void collectMeasurement() override;
         void power_up() override {};
         void power_down() override {};
         void package() override;
+        size_t getPackageSize() override { return MODULE_PACKAGE_SIZE(8); };
 
     public:
         /**
@@ -221,5 +232,16 @@ class Loom_SEN55 : public I2CDevice{
 
         int pmReadFrequency = 0;                   // Counter for the number of times we have read the PM values
 
+        /* Split measurement state */
+        uint8_t pmSamplesTaken = 0;                 // Number of PM samples taken so far this measurement
+        uint8_t failedReads = 0;                    // Number of PM samples that were not ready in time
+        SampleStatistics pmStats[PM_VALUES];        // Running average of each PM value, in the order readMeasuredPmValues() returns them
+        unsigned long nextReadTime = 0;             // millis() after which the next sample can be read
+        unsigned long readDeadline = 0;             // millis() after which we stop waiting for the next sample to be ready
+        bool dataReady = false;                     // Whether the sensor had data ready when we last checked
+        bool measurementReady = false;              // Whether every sample for this measurement has been taken
+
+        void addPMSample();                         // Read a single PM sample and add it to the running averages
+
 
 };
\ No newline at end of file
@@ -8,6 +8,8 @@ Loom_SHT31::Loom_SHT31(
                         bool useMux
                     ) : I2CDevice("SHT31"), manInst(&man), i2c_address(address){
                         module_address = address;
+                        addSampleField("Temperature_C", &sensorData[0]);
+                        addSampleField("Humidity_%RH", &sensorData[1]);
                         
                         // Register the module with the manager
                         if(!useMux)
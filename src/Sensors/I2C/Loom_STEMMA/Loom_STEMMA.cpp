@@ -8,6 +8,7 @@ Loom_STEMMA::Loom_STEMMA(
                         bool useMux  
                     ) : I2CDevice("STEMMA"), manInst(&man), address(addr) {
                         module_address = addr;
+                        addSampleField("Temperature_C", &temperature);
 
                         // Register the module with the manager
                         if(!useMux)
@@ -8,6 +8,7 @@ Loom_T6793::Loom_T6793(
                         uint8_t readDelay, // Delay for reading Wire in ms
                         bool useMux
                     ) : I2CDevice("T6793"), manInst(&man), i2s_addr(addr), wireReadDelay(readDelay){
+                        addSampleField("CO2", &CO2_Val);
 
                         // Register the module with the manager
                         if(!useMux)
@@ -51,37 +52,14 @@ void Loom_T6793::measure() {
     float CO2_Sample_Sum = 0;
     float CO2_Sample = 0;
     bool failed_read;
-    unsigned long startMillis;
 
     for(int i = 0; i < CO2_AVERAGE_COUNT; i++) {
 
         failed_read = false;
 
         byte data[4];
-        Wire.beginTransmission(i2s_addr);
-
-        Wire.write(0x04); 
-        Wire.write(0x13); 
-        Wire.write(0x8B); 
-        Wire.write(0x00); 
-        Wire.write(0x01);
-        
-        if (Wire.endTransmission() != 0) { 
-            failed_read = true;
-        }
-
-        // Read delay
-        startMillis = millis();
-        while((millis() - startMillis) < wireReadDelay) {}
-
-        Wire.requestFrom(i2s_addr, 4);
-        for (int j = 0; j < 4; j++) {
-            if (Wire.available()) {
-                 data[j] = Wire.read();
-            } else { 
-                failed_read = true; 
-            }
-        }
+        const uint8_t request[5] = {0x04, 0x13, 0x8B, 0x00, 0x01};
+        failed_read = !readRegisters(request, data, 4);
 
         if(!failed_read)
             CO2_Sample = ((data[2] & 0x3F) << 8) | data[3];
@@ -89,9 +67,8 @@ void Loom_T6793::measure() {
 
         CO2_Sample_Sum += CO2_Sample;
 
-        // Delay 250 ms between samples
-        startMillis = millis();
-        while((millis() - startMillis) < 150) {}
+        // Delay 150 ms between samples
+        Loom_Executor::getInstance()->wait(150);
     }
 
     CO2_Val = CO2_Sample_Sum / CO2_AVERAGE_COUNT;
@@ -115,25 +92,10 @@ void Loom_T6793::package() {
 bool Loom_T6793::GetSensorStatus() {
     FUNCTION_START;
     byte data[4];
-    Wire.beginTransmission(i2s_addr);
-
-    Wire.write(0x04); 
-    Wire.write(0x13); 
-    Wire.write(0x8A); 
-    Wire.write(0x00); 
-    Wire.write(0x01);
-
-    if (Wire.endTransmission() != 0) return false;
-
-    // Read delay
-    unsigned long startMillis = millis();
-    while((millis() - startMillis) < wireReadDelay) {}
-
-    // delay(readDelay);
-    Wire.requestFrom(i2s_addr, 4);
-    for (int i = 0; i < 4; i++) {
-        if (Wire.available()) data[i] = Wire.read();
-        else return false;
+    const uint8_t request[5] = {0x04, 0x13, 0x8A, 0x00, 0x01};
+    if(!readRegisters(request, data, 4)){
+        FUNCTION_END;
+        return false;
     }
 
     FUNCTION_END;
@@ -145,30 +107,26 @@ unsigned long Loom_T6793::GetSerialNo() {
 
     FUNCTION_START;
     byte data[6];
-    Wire.beginTransmission(i2s_addr);
-
-    Wire.write(0x03); 
-    Wire.write(0x0F); 
-    Wire.write(0xA2); 
-    Wire.write(0x00); 
-    Wire.write(0x02);
-
-    if (Wire.endTransmission() != 0) {
-        Serial.println("Serial Request Failed!");
+    const uint8_t request[5] = {0x03, 0x0F, 0xA2, 0x00, 0x02};
+    if(!readRegisters(request, data, 6)){
+        ERROR(F("Serial Request Failed!"));
+        FUNCTION_END;
         return 0;
     }
-
-    // Read delay
-    unsigned long startMillis = millis();
-    while((millis() - startMillis) < wireReadDelay) {}
-
-    // delay(readDelay);
-    Wire.requestFrom(i2s_addr, 6);
-    for (int i = 0; i < 6; i++) {
-        if (Wire.available()) data[i] = Wire.read();
-        else return 0;
-    }
     FUNCTION_END;
 
     return ((unsigned long)data[2] << 24) | ((unsigned long)data[3] << 16) | ((unsigned long)data[4] << 8) | (unsigned long)data[5];
-}
\ No newline at end of file
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_T6793::readRegisters(const uint8_t request[5], uint8_t* data, uint8_t length){
+    if(!Loom_I2CBus::getInstance()->write(i2s_addr, request, 5))
+        return false;
+
+    // The sensor needs time to process the request before the response can be read
+    Loom_Executor::getInstance()->wait(wireReadDelay);
+
+    return Loom_I2CBus::getInstance()->read(i2s_addr, data, length);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
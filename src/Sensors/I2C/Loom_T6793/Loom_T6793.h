@@ -5,6 +5,7 @@
 
 #include "../I2CDevice.h"
 #include "Loom_Manager.h"
+#include "Loom_I2CBus.h"
 
 #define CO2_AVERAGE_COUNT 10
 
@@ -60,5 +61,14 @@ class Loom_T6793 : public I2CDevice{
         uint8_t wireReadDelay;
         float CO2_Val;
 
+        /**
+         * Send a 5 byte Modbus style request, wait for the sensor to process it and read back the response
+         * @param request Function code, register address and register count
+         * @param data Where to put the response
+         * @param length Number of bytes in the response
+         * @return Whether both transactions succeeded
+         */
+        bool readRegisters(const uint8_t request[5], uint8_t* data, uint8_t length);
+
 
 };
\ No newline at end of file
@@ -8,6 +8,9 @@ Loom_VEML6075::Loom_VEML6075(
                             bool useMux
                     ) : I2CDevice("VEML6075"), manInst(&man), veml() {
                         module_address = address;
+                        addSampleField("UltravioletA_counts/(µW/cm^-2)", &UVA);
+                        addSampleField("UltravioletB_counts/(µW/cm^-2)", &UVB);
+                        addSampleField("UltravioletIndex", &UVI);
 
                         // Register the module with the manager
                         if(!useMux)
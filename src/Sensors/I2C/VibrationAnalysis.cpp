@@ -0,0 +1,151 @@
+#include "VibrationAnalysis.h"
+
+#define FFT_HEADROOM 14                 // Samples are scaled so the largest fits in this many bits, leaving room for the butterflies to grow
+
+static int16_t cosTable[BURST_SAMPLES / 2];     // Q15 twiddle factors, filled in on first use
+static int16_t sinTable[BURST_SAMPLES / 2];
+static bool tablesReady = false;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+static void buildTwiddles(){
+    for(int i = 0; i < BURST_SAMPLES / 2; i++){
+        cosTable[i] = (int16_t)lround(32767.0 * cos(2.0 * PI * i / BURST_SAMPLES));
+        sinTable[i] = (int16_t)lround(32767.0 * sin(2.0 * PI * i / BURST_SAMPLES));
+    }
+    tablesReady = true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * In place radix-2 FFT on Q15 data, each stage is halved so the output is the spectrum divided by BURST_SAMPLES and can't overflow
+ */
+static void fixedFFT(int16_t re[BURST_SAMPLES], int16_t im[BURST_SAMPLES]){
+    if(!tablesReady)
+        buildTwiddles();
+
+    // Put the samples in bit reversed order
+    for(uint16_t i = 1, j = 0; i < BURST_SAMPLES; i++){
+        uint16_t bit = BURST_SAMPLES >> 1;
+        for(; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+
+        if(i < j){
+            int16_t temp = re[i]; re[i] = re[j]; re[j] = temp;
+            temp = im[i]; im[i] = im[j]; im[j] = temp;
+        }
+    }
+
+    for(uint16_t len = 2; len <= BURST_SAMPLES; len <<= 1){
+        uint16_t half = len >> 1;
+        uint16_t step = BURST_SAMPLES / len;
+
+        for(uint16_t i = 0; i < BURST_SAMPLES; i += len){
+            for(uint16_t k = 0; k < half; k++){
+                int32_t wr = cosTable[k * step];
+                int32_t wi = -sinTable[k * step];
+                uint16_t a = i + k;
+                uint16_t b = a + half;
+
+                int32_t tr = (re[b] * wr - im[b] * wi) >> 15;
+                int32_t ti = (re[b] * wi + im[b] * wr) >> 15;
+
+                re[b] = (re[a] - tr) >> 1;
+                im[b] = (im[a] - ti) >> 1;
+                re[a] = (re[a] + tr) >> 1;
+                im[a] = (im[a] + ti) >> 1;
+            }
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void computeVibrationFeatures(int16_t samples[BURST_SAMPLES], uint16_t count, float countsPerG, float sampleRate, VibrationFeatures& features){
+    features = VibrationFeatures();
+    features.sampleRate = sampleRate;
+    features.samples = count = min(count, (uint16_t)BURST_SAMPLES);
+    if(count == 0 || countsPerG <= 0)
+        return;
+
+    // Remove the mean so gravity and any offset don't show up as vibration
+    int32_t sum = 0;
+    for(uint16_t i = 0; i < count; i++)
+        sum += samples[i];
+    int16_t mean = sum / count;
+
+    int64_t sumSquares = 0;
+    int32_t peak = 0;
+    for(uint16_t i = 0; i < count; i++){
+        int32_t value = (int32_t)samples[i] - mean;
+        sumSquares += (int64_t)value * value;
+        peak = max(peak, (int32_t)abs(value));
+    }
+
+    features.rms = sqrt((double)sumSquares / count) / countsPerG;
+    features.peak = peak / countsPerG;
+    features.crestFactor = (features.rms > 0) ? features.peak / features.rms : 0;
+
+    // Scale the samples so the largest uses the available headroom, the shift is undone on the band energies
+    int shift = 0;
+    if(peak > 0){
+        while((peak << (shift + 1)) < (1L << FFT_HEADROOM) && shift < 15)
+            shift++;
+        while(shift <= 0 && (peak >> -shift) >= (1L << FFT_HEADROOM))
+            shift--;
+    }
+
+    int16_t im[BURST_SAMPLES];
+    for(uint16_t i = 0; i < BURST_SAMPLES; i++){
+        int32_t value = (i < count) ? (int32_t)samples[i] - mean : 0;
+        samples[i] = (shift >= 0) ? value << shift : value >> -shift;
+        im[i] = 0;
+    }
+
+    fixedFFT(samples, im);
+
+    // Each bin between DC and Nyquist holds half of its power, the other half is in the mirrored bin, the Nyquist bin has no mirror and goes in the top band
+    const uint16_t bins = BURST_SAMPLES / 2 - 1;
+    for(uint16_t k = 1; k <= BURST_SAMPLES / 2; k++){
+        uint8_t band = min((uint32_t)(k - 1) * FFT_BANDS / bins, (uint32_t)FFT_BANDS - 1);
+        int32_t power = (int32_t)samples[k] * samples[k] + (int32_t)im[k] * im[k];
+        features.bandEnergy[band] += (k <= bins) ? 2.0f * power : (float)power;
+    }
+
+    // Back to g^2, the zero padding spread the energy over BURST_SAMPLES instead of count
+    float toG = ldexpf(1.0f, -2 * shift) / (countsPerG * countsPerG) * ((float)BURST_SAMPLES / count);
+    for(int i = 0; i < FFT_BANDS; i++)
+        features.bandEnergy[i] *= toG;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+int16_t selectVibrationAxis(int16_t x, int16_t y, int16_t z, VIBRATION_AXIS axis){
+    switch(axis){
+        case VIBRATION_AXIS::X: return x;
+        case VIBRATION_AXIS::Y: return y;
+        case VIBRATION_AXIS::Z: return z;
+        default:
+            // Halved so a full scale reading on every axis still fits
+            return (int16_t)(sqrtf((float)x * x + (float)y * y + (float)z * z) / 2);
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void packageVibrationFeatures(JsonObject json, const VibrationFeatures& features){
+    char name[20];
+
+    json["RMS_g"] = features.rms;
+    json["Peak_g"] = features.peak;
+    json["Crest_Factor"] = features.crestFactor;
+    json["Sample_Rate_Hz"] = features.sampleRate;
+    json["Samples"] = features.samples;
+
+    for(int i = 0; i < FFT_BANDS; i++){
+        snprintf(name, 20, "Band_%i_g2", i + 1);
+        json[name] = features.bandEnergy[i];
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
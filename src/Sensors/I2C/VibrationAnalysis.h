@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Arduino.h"
+#include <ArduinoJson.h>
+
+/* Burst capture setup */
+#ifndef BURST_SAMPLES
+    #define BURST_SAMPLES 128           // Samples captured per burst, must be a power of two for the FFT
+#endif
+
+#ifndef FFT_BANDS
+    #define FFT_BANDS 4                 // Number of equal width frequency bands the spectrum is split into between DC and the Nyquist frequency
+#endif
+
+#define BURST_TIMEOUT_MARGIN 100        // Extra milliseconds given to a burst on top of the time the samples should take
+#define BURST_CHUNK_SAMPLES 5           // Samples read from a FIFO per I2C transaction, keeps each read inside a 32 byte Wire buffer
+
+/**
+ * Which part of the acceleration the vibration features are computed on
+ */
+enum class VIBRATION_AXIS{
+    X,
+    Y,
+    Z,
+    MAGNITUDE                           // Length of the acceleration vector, doesn't depend on how the sensor is mounted
+};
+
+/**
+ * Summary of a burst of acceleration samples, this is packaged instead of the raw samples
+ */
+struct VibrationFeatures{
+    float rms = 0;                      // RMS of the signal with the mean (gravity) removed, g
+    float peak = 0;                     // Largest deviation from the mean, g
+    float crestFactor = 0;              // Peak / RMS
+    float bandEnergy[FFT_BANDS] = {0};  // Mean square in each frequency band, g^2, the bands add up to the RMS squared
+    float sampleRate = 0;               // Rate the burst was captured at, Hz
+    uint16_t samples = 0;               // Samples actually captured
+};
+
+/**
+ * Compute the vibration features from a burst of raw sensor readings
+ * The spectrum is computed with a Q15 fixed point FFT, the samples are scaled up or down to use the full range first
+ * @param samples Raw readings from the sensor, overwritten with the real part of the spectrum
+ * @param count Number of readings, anything short of BURST_SAMPLES is zero padded
+ * @param countsPerG Raw counts per g for the range the sensor was set to
+ * @param sampleRate Rate the samples were captured at in Hz
+ * @param features Where to put the results
+ */
+void computeVibrationFeatures(int16_t samples[BURST_SAMPLES], uint16_t count, float countsPerG, float sampleRate, VibrationFeatures& features);
+
+/**
+ * Reduce a 3 axis reading to the single value the features are computed on, the magnitude is halved so it always fits
+ * @param x Raw X reading
+ * @param y Raw Y reading
+ * @param z Raw Z reading
+ * @param axis Which axis to use
+ */
+int16_t selectVibrationAxis(int16_t x, int16_t y, int16_t z, VIBRATION_AXIS axis);
+
+/**
+ * Counts per g of the value selectVibrationAxis returns
+ * @param countsPerG Raw counts per g for the range the sensor was set to
+ * @param axis Which axis is being used
+ */
+inline float vibrationCountsPerG(float countsPerG, VIBRATION_AXIS axis) { return (axis == VIBRATION_AXIS::MAGNITUDE) ? countsPerG / 2 : countsPerG; };
+
+/**
+ * Add the features to the module's data object, only the summary is packaged
+ * @param json Data object for the module
+ * @param features Features to add
+ */
+void packageVibrationFeatures(JsonObject json, const VibrationFeatures& features);
+
+/* Number of fields packageVibrationFeatures adds */
+#define VIBRATION_PACKAGE_FIELDS (5 + FFT_BANDS)
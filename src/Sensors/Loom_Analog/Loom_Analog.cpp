@@ -1,23 +1,65 @@
 #include "Loom_Analog.h"
+#include "Logger.h"
+#include "Loom_DMA.h"
+#include "wiring_private.h"
 
+// Whether the scan's DMA transfer has finished
+static bool scanComplete(void* context){
+    return Loom_DMA::isComplete(ANALOG_DMA_CHANNEL);
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_Analog::measure(){
 
-    // Read the data from the given analog pin
+    // The median filter needs several readings, everything else only needs one
+    uint8_t passes = 1;
     for(int i = 0; i < pinMappings.size(); i++){
+        if(pinMappings[i]->filter == ANALOG_FILTER::MEDIAN)
+            passes = ANALOG_MEDIAN_SIZE;
+    }
+
+    for(uint8_t pass = 0; pass < passes; pass++){
+        if(dmaScan && scanChannels(pass))
+            continue;
+
+        // Read the data from the given analog pin
+        for(int i = 0; i < pinMappings.size(); i++){
+            if(pass == 0 || pinMappings[i]->filter == ANALOG_FILTER::MEDIAN)
+                pinMappings[i]->readings[pass] = readChannel(pinMappings[i]->pinNumber, pinMappings[i]->oversample);
+        }
+    }
+
+    for(int i = 0; i < pinMappings.size(); i++){
+        AnalogMapping* mapping = pinMappings[i];
+        float value = mapping->readings[0];
+
+        if(mapping->filter == ANALOG_FILTER::MEDIAN){
+            // Insertion sort, there are only a handful of readings
+            float sorted[ANALOG_MEDIAN_SIZE];
+            for(int j = 0; j < ANALOG_MEDIAN_SIZE; j++){
+                int k = j;
+                for(; k > 0 && sorted[k - 1] > mapping->readings[j]; k--)
+                    sorted[k] = sorted[k - 1];
+                sorted[k] = mapping->readings[j];
+            }
+            value = sorted[ANALOG_MEDIAN_SIZE / 2];
+        }
+        else if(mapping->filter == ANALOG_FILTER::IIR){
+            mapping->filtered = (mapping->filterPrimed) ? mapping->filtered + mapping->alpha * (value - mapping->filtered) : value;
+            mapping->filterPrimed = true;
+            value = mapping->filtered;
+        }
 
         /* If we are measuring the Vbat pin we want a little different behavior */
-        if(pinMappings[i]->pinNumber == A7){
-            pinMappings[i]->analog = getBatteryVoltage();
-            pinMappings[i]->analog_mv = getBatteryVoltage() * 1000;
+        if(mapping->pinNumber == A7){
+            mapping->analog = value * 2 * 3.3 / 4096;
+            mapping->analog_mv = mapping->analog * 1000;
         }
 
-        /* If its a normal pin then just read the value and update the previous values */
+        /* If its a normal pin then just update the previous values */
         else{
-            int analogData = analogRead(pinMappings[i]->pinNumber);
-            pinMappings[i]->analog = analogData;
-            pinMappings[i]->analog_mv = analogToMV(analogData);
+            mapping->analog = value;
+            mapping->analog_mv = analogToMV(value);
         }
     }
 }
@@ -43,7 +85,7 @@ void Loom_Analog::package(){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 float Loom_Analog::getBatteryVoltage(){
-    float pin_reading = analogRead(A7);
+    float pin_reading = readChannel(A7, BATTERY_OVERSAMPLE);
     pin_reading *= 2;
     pin_reading *= 3.3;
     pin_reading /= 4096;
@@ -53,15 +95,15 @@ float Loom_Analog::getBatteryVoltage(){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 char* Loom_Analog::pinNumberToName(int pin){
-    // Malloc a name of size 4 
-    char* name = (char*)malloc(sizeof(char) * 4);
+    // Allocate a name of size 4 from the arena, these live as long as the module
+    char* name = Loom_Arena::getInstance()->allocateString(4);
     snprintf_P(name, 4, PSTR("A%i"), pin - 14);
     return name;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-float Loom_Analog::analogToMV(int analog){
+float Loom_Analog::analogToMV(float analog){
     float analogRes = 4095.0;
     float voltage = (analog * 3.3) / analogRes;
     return voltage * 1000;
@@ -86,4 +128,169 @@ float Loom_Analog::getAnalog(int pin) {
         }
     }
 }
-//////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+AnalogMapping* Loom_Analog::findMapping(int pin){
+    for(int i = 0; i < pinMappings.size(); i++){
+        if(pinMappings[i]->pinNumber == pin)
+            return pinMappings[i];
+    }
+    return nullptr;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Analog::setOversampling(int pin, uint16_t samples){
+    AnalogMapping* mapping = findMapping(pin);
+    if(mapping == nullptr){
+        WARNINGF("Pin %i isn't being read, oversampling not set", pin);
+        return;
+    }
+
+    // The hardware can only average powers of two
+    uint16_t rounded = 1;
+    while(rounded * 2 <= min(samples, (uint16_t)MAX_OVERSAMPLE))
+        rounded *= 2;
+    mapping->oversample = rounded;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Analog::setFilter(int pin, ANALOG_FILTER filter, float alpha){
+    AnalogMapping* mapping = findMapping(pin);
+    if(mapping == nullptr){
+        WARNINGF("Pin %i isn't being read, filter not set", pin);
+        return;
+    }
+
+    mapping->filter = filter;
+    mapping->alpha = constrain(alpha, 0.0f, 1.0f);
+    mapping->filterPrimed = false;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t Loom_Analog::configureAveraging(uint8_t samplesLog2){
+    // Hand back whatever was set before so a sketch that changed analogReadResolution() keeps its resolution
+    uint32_t previous = ((uint32_t)ADC->CTRLB.reg << 8) | ADC->AVGCTRL.reg;
+
+    // Averaging only works with the 16 bit result, single conversions are read at 12 bits to match resultToCounts()
+    if(samplesLog2 == 0){
+        ADC->CTRLB.bit.RESSEL = ADC_CTRLB_RESSEL_12BIT_Val;
+        ADC->AVGCTRL.reg = 0;
+    }
+    else{
+        ADC->CTRLB.bit.RESSEL = ADC_CTRLB_RESSEL_16BIT_Val;
+        ADC->AVGCTRL.reg = ADC_AVGCTRL_SAMPLENUM(samplesLog2) | ADC_AVGCTRL_ADJRES(0);
+    }
+    while(ADC->STATUS.bit.SYNCBUSY);
+    return previous;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_Analog::restoreAveraging(uint32_t previous){
+    ADC->CTRLB.reg = (uint16_t)(previous >> 8);
+    ADC->AVGCTRL.reg = (uint8_t)previous;
+    while(ADC->STATUS.bit.SYNCBUSY);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+float Loom_Analog::resultToCounts(uint16_t result, uint8_t samplesLog2){
+    // The ADC accumulates 12+n bits and shifts anything past 16 bits off itself, so divide by whatever is left over
+    return result / (float)(1 << min(samplesLog2, (uint8_t)4));
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+float Loom_Analog::readChannel(int pin, uint16_t samples){
+    if(samples <= 1)
+        return analogRead(pin);
+
+    uint8_t samplesLog2 = 0;
+    while((1 << (samplesLog2 + 1)) <= samples)
+        samplesLog2++;
+
+    uint32_t previous = configureAveraging(samplesLog2);
+    uint16_t result = analogRead(pin);
+    restoreAveraging(previous);
+
+    return resultToCounts(result, samplesLog2);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_Analog::scanChannels(uint8_t pass){
+    uint8_t first = 0xFF;
+    uint8_t last = 0;
+    uint16_t samples = 1;
+
+    // The ADC can only scan a consecutive range of inputs so cover everything from the lowest to the highest pin
+    for(int i = 0; i < pinMappings.size(); i++){
+        uint8_t input = g_APinDescription[pinMappings[i]->pinNumber].ulADCChannelNumber;
+        first = min(first, input);
+        last = max(last, input);
+        samples = max(samples, pinMappings[i]->oversample);
+        pinPeripheral(pinMappings[i]->pinNumber, PIO_ANALOG);
+    }
+    if(first > last)
+        return false;
+
+    // The first conversion after enabling the ADC isn't reliable so the scan wraps around and converts the first input again
+    uint8_t count = last - first + 1;
+    uint8_t samplesLog2 = 0;
+    while((1 << (samplesLog2 + 1)) <= samples)
+        samplesLog2++;
+
+    // Move each result into the buffer as soon as it is ready
+    DmacDescriptor* descriptor = Loom_DMA::getDescriptor(ANALOG_DMA_CHANNEL);
+    Loom_DMA::configureChannel(ANALOG_DMA_CHANNEL, ADC_DMAC_ID_RESRDY);
+    descriptor->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_HWORD | DMAC_BTCTRL_DSTINC | DMAC_BTCTRL_BLOCKACT_NOACT;
+    descriptor->BTCNT.reg = count + 1;
+    descriptor->SRCADDR.reg = (uint32_t)&ADC->RESULT.reg;
+    descriptor->DSTADDR.reg = (uint32_t)(scanBuffer + count + 1);        // The end address when incrementing
+    descriptor->DESCADDR.reg = 0;
+    Loom_DMA::startChannel(ANALOG_DMA_CHANNEL);
+
+    // Free run through the inputs, the ADC averages each one before moving on
+    uint32_t previous = configureAveraging(samplesLog2);
+    ADC->INPUTCTRL.bit.MUXPOS = first;
+    ADC->INPUTCTRL.bit.INPUTSCAN = count - 1;
+    ADC->INPUTCTRL.bit.INPUTOFFSET = 0;
+    while(ADC->STATUS.bit.SYNCBUSY);
+    ADC->CTRLB.bit.FREERUN = 1;
+    while(ADC->STATUS.bit.SYNCBUSY);
+    ADC->CTRLA.bit.ENABLE = 1;
+    while(ADC->STATUS.bit.SYNCBUSY);
+    ADC->SWTRIG.bit.START = 1;
+
+    // Every input in the scan plus the repeated first one is averaged over 2^n conversions
+    uint32_t timeout = ((uint32_t)(count + 1) * (1UL << samplesLog2) * ANALOG_CONVERSION_US) / 1000 + ANALOG_SCAN_MARGIN;
+
+    // Everything else gets to run while the scan happens
+    bool finished = Loom_Executor::getInstance()->waitFor(scanComplete, nullptr, timeout);
+
+    // Put the ADC back how analogRead() expects it
+    ADC->CTRLA.bit.ENABLE = 0;
+    while(ADC->STATUS.bit.SYNCBUSY);
+    ADC->INPUTCTRL.bit.INPUTSCAN = 0;
+    ADC->INPUTCTRL.bit.INPUTOFFSET = 0;
+    while(ADC->STATUS.bit.SYNCBUSY);
+    restoreAveraging(previous);                 // Also clears FREERUN, it was saved before it was set
+
+    Loom_DMA::stopChannel(ANALOG_DMA_CHANNEL);
+
+    if(!finished){
+        WARNING(F("DMA scan timed out, reading the pins one at a time"));
+        return false;
+    }
+
+    for(int i = 0; i < pinMappings.size(); i++){
+        uint8_t offset = g_APinDescription[pinMappings[i]->pinNumber].ulADCChannelNumber - first;
+        pinMappings[i]->readings[pass] = resultToCounts(scanBuffer[(offset == 0) ? count : offset], samplesLog2);
+    }
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -6,6 +6,26 @@
 #include "Module.h"
 #include "Loom_Manager.h"
 
+/* Sampling pipeline */
+#define MAX_OVERSAMPLE 1024         // Most conversions the ADC can average in hardware
+#define BATTERY_OVERSAMPLE 16       // Conversions averaged by getBatteryVoltage()
+#define ANALOG_MEDIAN_SIZE 5        // Oversampled readings the median filter picks from
+#define ANALOG_CONVERSION_US 420    // Microseconds one conversion takes with the core's DIV512 prescaler and SAMPLEN 63
+#define ANALOG_SCAN_MARGIN 20       // Milliseconds added to the expected length of a DMA scan before it is treated as stuck
+
+#ifndef ANALOG_DMA_CHANNEL
+    #define ANALOG_DMA_CHANNEL 11   // DMA channel used for the multi-channel scan, the last one so it is unlikely to be used by anything else
+#endif
+
+/**
+ * Filter applied to each reading of a channel
+ */
+enum class ANALOG_FILTER{
+    NONE,
+    MEDIAN,                         // Median of ANALOG_MEDIAN_SIZE readings taken back to back, removes spikes
+    IIR                             // Exponential smoothing across measurements, removes slow noise
+};
+
 /* Contain all the information regarding the analog pin that we want to use*/
 struct AnalogMapping{
     int pinNumber;
@@ -13,6 +33,13 @@ struct AnalogMapping{
     float analog;
     float analog_mv;
 
+    uint16_t oversample = 1;                        // Conversions averaged in hardware for each reading
+    ANALOG_FILTER filter = ANALOG_FILTER::NONE;     // Filter applied to the readings
+    float alpha = 0.25;                             // Weight of a new reading when using the IIR filter
+    bool filterPrimed = false;                      // Whether the IIR filter has a previous value yet
+    float filtered = 0;                             // Output of the IIR filter in counts
+    float readings[ANALOG_MEDIAN_SIZE];             // Readings taken this measurement in counts
+
     /* Construct a new analog mapping */
     AnalogMapping(int pinNumber, const char* name, float analog, float analog_mv){
         this->pinNumber = pinNumber;
@@ -40,6 +67,9 @@ class Loom_Analog : public Module{
         void measure() override;                               
         void package() override;
 
+        // Each pin packages a raw and millivolt value, the millivolt key is copied into the document
+        size_t getPackageSize() override { return MODULE_PACKAGE_SIZE(pinMappings.size() * 2) + pinMappings.size() * JSON_STRING_SIZE(10); };
+
         /**
          * Templated constructor that uses more than 1 analog pin
          * @param man Reference to the manager
@@ -109,6 +139,29 @@ class Loom_Analog : public Module{
          */ 
         float getAnalog(int pin);
 
+        /**
+         * Average a number of conversions for each reading using the ADC's hardware averaging, 256 conversions gives 16 bits of effective resolution
+         * Values are still reported on the 12 bit scale but are no longer whole numbers
+         * @param pin The pin to configure eg. A0, A1, ...
+         * @param samples Number of conversions, rounded down to a power of two up to 1024
+         */
+        void setOversampling(int pin, uint16_t samples);
+
+        /**
+         * Filter the readings of a pin
+         * @param pin The pin to configure eg. A0, A1, ...
+         * @param filter Filter to use
+         * @param alpha Weight of each new reading when using the IIR filter, between 0 and 1
+         */
+        void setFilter(int pin, ANALOG_FILTER filter, float alpha = 0.25);
+
+        /**
+         * Convert every pin in one scan of the ADC with the results moved by DMA instead of reading the pins one at a time
+         * The ADC averages the same number of conversions for every input in a scan so the largest oversampling of any pin is used
+         * @param enable Whether or not to use the DMA scan
+         */
+        void setDMAScan(bool enable) { dmaScan = enable; };
+
     private:
 
         /** 
@@ -129,11 +182,20 @@ class Loom_Analog : public Module{
             return get_variadic_parameters(args...);
         };
 
-        float analogToMV(int analog);               // Convert the analog voltage to mV
+        float analogToMV(float analog);             // Convert the analog voltage to mV
         char* pinNumberToName(int pin);             // Convert the given to a name with the style "A0"
+        AnalogMapping* findMapping(int pin);        // Get the mapping for the pin, null if it isn't being read
+
+        static float readChannel(int pin, uint16_t samples);       // Read a pin averaging the given number of conversions, returns counts on the 12 bit scale
+        static uint32_t configureAveraging(uint8_t samplesLog2);   // Set the ADC up to average 2^samplesLog2 conversions, returns the previous settings for restoreAveraging()
+        static void restoreAveraging(uint32_t previous);           // Put back the resolution and averaging saved by configureAveraging()
+        static float resultToCounts(uint16_t result, uint8_t samplesLog2);     // Scale an averaged result back to the 12 bit scale
+        bool scanChannels(uint8_t pass);            // Read every pin in one DMA driven scan, stores the results in the given reading slot
 
         Manager* manInst;                           // Instance of the manager
         std::vector<AnalogMapping*> pinMappings;    // Contains a struct for each pin we are monitoring 
+        bool dmaScan = false;                       // Read every pin with one DMA scan
+        uint16_t scanBuffer[ADC_INPUTCTRL_MUXPOS_PIN19_Val + 2];    // Results of the DMA scan, one per input between the lowest and highest pin plus the repeated first input
         
 
 };
\ No newline at end of file
@@ -23,63 +23,294 @@ void Loom_SDI12::initialize(){
     sdiInterface.begin();
     delay(100);
 
-    // Create a list of addresses that have a sensor connected to them
-    inUseAddresses = scanAddressSpace();
+    // Checking the sensors we already know about is much quicker than probing every address, only scan if something changed
+    if(fullScan || !loadAddressCache()){
+
+        // Create a list of addresses that have a sensor connected to them
+        inUseAddresses = scanAddressSpace();
+
+        // Request the sensor data from all connected devices to pull the sensor name
+        for(int i = 0; i < inUseAddresses.size(); i++){
+            char response[RESPONSE_SIZE] = {0};
+            requestSensorInfo(response, inUseAddresses[i]);
+            response[RESPONSE_SIZE-1] = '\0';
+
+            // Only keep as much of the info string as the sensor actually returned, these are kept for the lifetime of the module
+            addressToType.insert(std::pair<char, const char*>(inUseAddresses[i], Loom_Arena::getInstance()->copyString(response)));
+        }
+
+        saveAddressCache();
+    }
 
-    // Request the sensor data from all connected devices to pull the sensor name
     for(int i = 0; i < inUseAddresses.size(); i++){
-        char* response = (char*) malloc(sizeof(char) * RESPONSE_SIZE);
-        memset(response, '\0', RESPONSE_SIZE);
-        requestSensorInfo(response, inUseAddresses[i]);
-        addressToType.insert(std::pair<char, const char*>(inUseAddresses[i], response));
+        // Allocate a string for each SDI device to store a name
+        sensorNames.push_back(Loom_Arena::getInstance()->allocateString(SENSOR_NAME_SIZE));
 
-        // Allocate string of size 100 for each SDI device to store a name
-        sensorNames.push_back((char*) malloc(sizeof(char) * 100));
-        memset(sensorNames[i], '\0', 100);
+        SensorMeasurement measurement;
+        measurement.addr = inUseAddresses[i];
+        measurements.push_back(measurement);
     }
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-void Loom_SDI12::measure(){
+void Loom_SDI12::startMeasurement(){
    
     // On measure we also want to reset the mode to output in case the 4G board has messed with it
     pinMode(sdiInterface.getDataPin(), OUTPUT);
     delay(30);
 
-    // Populate the variables that will be used to package data
-    for(int i = 0; i < inUseAddresses.size(); i++){
-        getData(inUseAddresses[i]);
+    // Look for new sensors before anything starts measuring, probing another address would abort an M! measurement
+    if(incrementalScan)
+        scanIncrementally();
+
+    // Every sensor that supports it measures at the same time so the whole bus takes about as long as the slowest sensor
+    for(int i = 0; i < measurements.size(); i++){
+        measurements[i].started = false;
+        measurements[i].collected = false;
+        measurements[i].attempts = 0;
+        measurements[i].concurrent = useConcurrent && measurements[i].supportsConcurrent;
+
+        if(measurements[i].concurrent)
+            requestMeasurement(measurements[i]);
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_SDI12::isMeasurementReady(){
+    bool waiting = false;
+
+    // Collect whatever has finished
+    for(int i = 0; i < measurements.size(); i++){
+        if(!measurements[i].started || measurements[i].collected)
+            continue;
+
+        // A sensor measured with M! sends its address as a service request once its data is ready, which can be well before the time it gave
+        if(!measurements[i].concurrent && (long)(millis() - measurements[i].readyTime) < 0 && serviceRequested(measurements[i].addr))
+            measurements[i].readyTime = millis();
+
+        if((long)(millis() - measurements[i].readyTime) < 0){
+            waiting = true;
+            continue;
+        }
+
+        collectData(measurements[i]);
+        if(!measurements[i].collected)
+            waiting = true;
+    }
+
+    if(waiting)
+        return false;
+
+    // Talking to another sensor aborts an M! measurement so sensors without C! are measured one at a time once everything else is done
+    for(int i = 0; i < measurements.size(); i++){
+        if(!measurements[i].collected){
+            requestMeasurement(measurements[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_SDI12::requestMeasurement(SensorMeasurement& measurement){
+    char response[RESPONSE_SIZE];
+    sendCommand(response, measurement.addr, measurement.concurrent ? "C!" : "M!");
+
+    // Sensors older than SDI-12 v1.2 don't support concurrent measurements and won't answer, measure them on their own later
+    if(measurement.concurrent && strlen(response) == 0){
+        WARNINGF("Sensor %c doesn't support concurrent measurements", measurement.addr);
+        measurement.concurrent = false;
+        measurement.supportsConcurrent = false;
+        measurement.started = false;
+        return;
+    }
+
+    measurement.started = true;
+    measurement.attempts++;
+
+    // The response is atttn (atttnn for C!) where ttt is the number of seconds until the data is ready and n is the number of values
+    unsigned long waitTime = 0;
+    if(strlen(response) >= 4){
+        char seconds[4] = {response[1], response[2], response[3], '\0'};
+        waitTime = atoi(seconds) * 1000UL;
+    }
+    measurement.expected = (strlen(response) >= 5) ? min(atoi(&response[4]), MAX_SDI12_VALUES) : 0;
+    measurement.readyTime = millis() + waitTime;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_SDI12::collectData(SensorMeasurement& measurement){
+    char response[RESPONSE_SIZE];
+    char command[4];
+    float values[MAX_SDI12_VALUES];
+    uint8_t count = 0;
+
+    // A response only holds so many characters so the values can be split across D0! to D9!, keep reading until we have as many as the sensor promised
+    for(int i = 0; i <= 9 && (i == 0 || count < measurement.expected); i++){
+        snprintf(command, 4, "D%i!", i);
+        sendCommand(response, measurement.addr, command);
+
+        uint8_t previous = count;
+        count = parseValues(response, values, count);
+        if(count == previous)
+            break;
+    }
+
+    // If there were no values we want to re-request data once the sensor has had some time
+    if(count == 0 && measurement.attempts < MEASURE_ATTEMPTS){
+        WARNING(F("Invalid data received! Retrying..."));
+        requestMeasurement(measurement);
+        measurement.readyTime = max(measurement.readyTime, millis() + RETRY_DELAY);
+        return;
+    }
+
+    if(count > 0){
+        if(count < measurement.expected)
+            WARNINGF("Only received %i of %i values from sensor %c", count, measurement.expected, measurement.addr);
+
+        memcpy(measurement.values, values, count * sizeof(float));
+        measurement.count = count;
+    }
+    else{
+        ERROR(F("Failed to record new data! Using previous valid information!"));
     }
-    
+
+    lastAddress = measurement.addr;
+    measurement.collected = true;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint8_t Loom_SDI12::parseValues(const char* response, float values[MAX_SDI12_VALUES], uint8_t count){
+    if(strlen(response) <= 1)
+        return count;
+
+    // Skip the address, every value starts with its sign which also separates it from the last one
+    const char* p = response + 1;
+    while(*p != '\0' && count < MAX_SDI12_VALUES){
+        if(*p != '+' && *p != '-'){
+            p++;
+            continue;
+        }
+
+        char* end;
+        float value = strtod(p, &end);
+        if(end == p)
+            break;
+
+        values[count++] = value;
+        p = end;
+    }
+    return count;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_SDI12::package(){
-    
+    char fieldName[SENSOR_NAME_SIZE];
+
     for(int i = 0; i < inUseAddresses.size(); i++){
-        if(strstr(getSensorInfo(inUseAddresses[i]), "GS3") != NULL){
-            if(strlen(sensorNames[i]) <= 0){
-                snprintf(sensorNames[i], 100, "GS3_%i", i);
-            }
-            JsonObject json = manInst->get_data_object(sensorNames[i]);
-            json["Temperature"] = sensorData[0];
-            json["Dielectric_Permittivity"] = sensorData[1];
-            json["Conductivity"] = sensorData[2];
+        SensorMeasurement* measurement = findMeasurement(inUseAddresses[i]);
+        if(measurement == nullptr || measurement->count == 0)
+            continue;
+
+        const SDI12SensorType* type = findSensorType(inUseAddresses[i]);
+        if(strlen(sensorNames[i]) <= 0){
+            snprintf(sensorNames[i], SENSOR_NAME_SIZE, "%s_%i", (type != nullptr) ? type->name : "SDI12", i);
         }
-        else if(strstr(getSensorInfo(inUseAddresses[i]), "TER") != NULL){
-            if(strlen(sensorNames[i]) <= 0){
-                snprintf(sensorNames[i], 100, "TER_%i", i);
+
+        // Registered types only package the values they name so they stay inside what getPackageSize() budgeted, unknown sensors are numbered instead
+        JsonObject json = manInst->get_data_object(sensorNames[i]);
+        for(int j = 0; j < measurement->count; j++){
+            if(type != nullptr){
+                if(type->fields[j] == nullptr)
+                    break;
+                json[type->fields[j]] = measurement->values[j];
             }
-            JsonObject json = manInst->get_data_object(sensorNames[i]);
-            json["Temperature"] = sensorData[0];
-            json["Volumetric_Water_Content"] = sensorData[1];
-            if(strstr(getSensorInfo(inUseAddresses[i]), "TER12") != NULL)
-                json["Conductivity"] = sensorData[2];
+            else{
+                snprintf(fieldName, SENSOR_NAME_SIZE, "Value_%i", j + 1);
+                json[fieldName] = measurement->values[j];
+            }
+        }
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t Loom_SDI12::getPackageSize(){
+    size_t size = 0;
+    for(int i = 0; i < inUseAddresses.size(); i++){
+        const SDI12SensorType* type = findSensorType(inUseAddresses[i]);
+
+        // The sensor name is copied into the document
+        size += MODULE_PACKAGE_SIZE(0) + SENSOR_NAME_SIZE;
+        if(type != nullptr){
+            int fields;
+            for(fields = 0; fields < MAX_SDI12_VALUES && type->fields[fields] != nullptr; fields++);
+            size += JSON_OBJECT_SIZE(fields);
+        }
+        else{
+            // Unknown sensors can return as many values as are stored, each under a copied Value_n key
+            size += JSON_OBJECT_SIZE(MAX_SDI12_VALUES) + MAX_SDI12_VALUES * VALUE_KEY_SIZE;
         }
     }
-    
+    return size;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_SDI12::registerSensorType(const SDI12SensorType& type){
+    sdi12SensorTypes().insert(sdi12SensorTypes().begin(), type);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+const SDI12SensorType* Loom_SDI12::findSensorType(char addr){
+    return matchSDI12SensorType(getSensorInfo(addr));
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+Loom_SDI12::SensorMeasurement* Loom_SDI12::findMeasurement(char addr){
+    for(int i = 0; i < measurements.size(); i++){
+        if(measurements[i].addr == addr)
+            return &measurements[i];
+    }
+    return nullptr;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+float Loom_SDI12::getValue(char addr, uint8_t index){
+    SensorMeasurement* measurement = findMeasurement(addr);
+    if(measurement == nullptr || index >= measurement->count)
+        return NAN;
+    return measurement->values[index];
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+float Loom_SDI12::getValue(char addr, const char* field){
+    const SDI12SensorType* type = findSensorType(addr);
+    if(type == nullptr)
+        return NAN;
+
+    for(int i = 0; i < MAX_SDI12_VALUES && type->fields[i] != nullptr; i++){
+        if(strcmp(type->fields[i], field) == 0)
+            return getValue(addr, (uint8_t)i);
+    }
+    return NAN;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+uint8_t Loom_SDI12::getValueCount(char addr){
+    SensorMeasurement* measurement = findMeasurement(addr);
+    return (measurement != nullptr) ? measurement->count : 0;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -141,6 +372,107 @@ std::vector<char> Loom_SDI12::scanAddressSpace(){
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+SDManager* Loom_SDI12::getCacheSD(){
+    if(hypnosInst == nullptr || hypnosInst->getSDManager() == nullptr || !hypnosInst->getSDManager()->hasSDInitialized())
+        return nullptr;
+    return hypnosInst->getSDManager();
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_SDI12::loadAddressCache(){
+    SDManager* sd = getCacheSD();
+    if(sd == nullptr || !sd->fileExists(SDI12_CACHE_FILE))
+        return false;
+
+    LOG(F("Checking cached SDI-12 sensors..."));
+    char* contents = sd->readFile(SDI12_CACHE_FILE);
+    char response[RESPONSE_SIZE];
+    std::vector<char*> cachedInfo;
+    bool matched = true;
+
+    // Each line is the I! response of a sensor, which starts with its address
+    char* line = strtok(contents, "\r\n");
+    while(line != NULL){
+        requestSensorInfo(response, line[0]);
+        for(int i = 1; i < MEASURE_ATTEMPTS && strlen(response) == 0; i++)
+            requestSensorInfo(response, line[0]);
+
+        // A sensor was removed, swapped or re-addressed
+        if(strcmp(response, line) != 0){
+            WARNINGF("Sensor at address %c doesn't match the cache, rescanning", line[0]);
+            matched = false;
+            break;
+        }
+
+        cachedInfo.push_back(line);
+        line = strtok(NULL, "\r\n");
+    }
+
+    if(matched && cachedInfo.size() > 0){
+        for(int i = 0; i < cachedInfo.size(); i++){
+            inUseAddresses.push_back(cachedInfo[i][0]);
+            addressToType.insert(std::pair<char, const char*>(cachedInfo[i][0], Loom_Arena::getInstance()->copyString(cachedInfo[i])));
+        }
+        LOGF("All %i cached SDI-12 sensors found, skipping the scan", (int)inUseAddresses.size());
+    }
+    free(contents);
+
+    return matched && cachedInfo.size() > 0;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_SDI12::saveAddressCache(){
+    SDManager* sd = getCacheSD();
+    if(sd == nullptr)
+        return;
+
+    sd->removeFile(SDI12_CACHE_FILE);
+    for(int i = 0; i < inUseAddresses.size(); i++)
+        sd->writeLineToFile(SDI12_CACHE_FILE, getSensorInfo(inUseAddresses[i]));
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+void Loom_SDI12::scanIncrementally(){
+    char response[RESPONSE_SIZE];
+
+    for(int i = 0; i < SCAN_ADDRESSES_PER_CYCLE; i++){
+        char addr = nextScanAddress;
+
+        // Walk 0-9, a-z then A-Z and start over
+        if(nextScanAddress == '9')
+            nextScanAddress = 'a';
+        else if(nextScanAddress == 'z')
+            nextScanAddress = 'A';
+        else if(nextScanAddress == 'Z')
+            nextScanAddress = '0';
+        else
+            nextScanAddress++;
+
+        if(std::find(inUseAddresses.begin(), inUseAddresses.end(), addr) != inUseAddresses.end() ||
+           std::find(discoveredAddresses.begin(), discoveredAddresses.end(), addr) != discoveredAddresses.end())
+            continue;
+
+        // Only one attempt per address so the scan doesn't hold up the measurement
+        sendCommand(response, addr, "!");
+        if(strlen(response) == 0)
+            continue;
+
+        requestSensorInfo(response, addr);
+        discoveredAddresses.push_back(addr);
+        WARNINGF("New SDI-12 sensor found at address %c, it will be measured after the next restart", addr);
+
+        // The package size is fixed after initialize so the sensor is only added to the cache for the next boot
+        SDManager* sd = getCacheSD();
+        if(sd != nullptr && strlen(response) > 0)
+            sd->writeLineToFile(SDI12_CACHE_FILE, response);
+    }
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 bool Loom_SDI12::checkActive(char addr){
     // Attempt to contact the sensor 3 times
@@ -170,43 +502,61 @@ const char* Loom_SDI12::getSensorInfo(char addr){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_SDI12::sendCommand(char response[RESPONSE_SIZE], char addr, const char* command){
-    // Send a request to the sensor at the given address and then wait 30ms before continuing
+    // Send a request to the sensor at the given address, readResponse waits for the reply
     char output[25];
     memset(output, '\0', 25);
     snprintf(output, 25, "%c%s", addr, command);
+
+    // Drop anything left over, like the service request a sensor sends when an M! measurement finishes, so it isn't read as the reply
+    sdiInterface.clearBuffer();
     sdiInterface.sendCommand(output);
-    delay(30);
     readResponse(response);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Loom_SDI12::serviceRequested(char addr){
+    if(!sdiInterface.available())
+        return false;
+
+    char response[RESPONSE_SIZE];
+    readResponse(response);
+    return response[0] == addr;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_SDI12::readResponse(char response[RESPONSE_SIZE]){
     int index = 0;
     memset(response, '\0', RESPONSE_SIZE);
-    // While data is available to be read read until an end line character appears.
-    while(sdiInterface.available()){
+
+    // SDI-12 runs at 1200 baud so characters trickle in, read each one as it arrives until the end line or the sensor goes quiet
+    unsigned long lastCharTime = millis();
+    while(millis() - lastCharTime < CHARACTER_TIMEOUT){
+        if(!sdiInterface.available()){
+            Loom_Executor::getInstance()->wait(1);
+            continue;
+        }
+
         char c = sdiInterface.read();
+        lastCharTime = millis();
 
         // Command responses terminate with an endline so we should stop when we see this
-        if (c == '\n'){
-            response[index] = '\0';
+        if (c == '\n')
             break;
-        }
 
-        // If we are under 30 then add the data to the array
-        if(index < RESPONSE_SIZE){
+        // Leave room for the null terminator
+        if(index < RESPONSE_SIZE - 1){
             response[index] = c;
         }
 
         index++;
-        delay(20); // SDI-12 is slow so we need to wait after each character
     }
 
     // Replace the carriage return with a null-byte
     char* pch = strstr(response, "\r");
     if(pch != NULL){
-        response[pch-response] == '\0';
+        *pch = '\0';
     }
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -219,63 +569,27 @@ void Loom_SDI12::requestSensorInfo(char response[RESPONSE_SIZE], char addr){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_SDI12::getData(char addr){
-    char		buf[20];
-	char*		p;
-    char        response[RESPONSE_SIZE];
-
-    // Request a measurement from the sensor at the given address
-    sendCommand(response, addr, "M!");
-    sendCommand(response, addr, "D0!");
-    
-    // If the value returned was 0 we want to re-request data
-    if(strlen(response) == 1){
-        WARNING(F("Invalid data received! Retrying..."));
-        delay(3000);
-
-        // Request a measurement from the sensor at the given address
-        sendCommand(response, addr, "M!");
-        sendCommand(response, addr, "D0!");
-
-        TIMER_RESET;
-	    if(strlen(response) == 1){
-            WARNING(F("Retrying for a second time..."));
-            delay(3000);
 
-            // Request a measurement from the sensor at the given address
-            sendCommand(response, addr, "M!");
-            sendCommand(response, addr, "D0!");
-            TIMER_RESET;
-            
-	    }
+    // Sensors used outside of the manager don't have measurement state yet
+    if(findMeasurement(addr) == nullptr){
+        SensorMeasurement newMeasurement;
+        newMeasurement.addr = addr;
+        measurements.push_back(newMeasurement);
     }
-
-    // Check if there is actually data to store in the variables
-    if(strlen(response) > 1){
-        // If the sensor is a copy the used values an
-        if(strstr(getSensorInfo(addr), "GS3") != NULL){
-            // Read out the results and parse out each of the data readings and pares them to floats
-            p = strtok(response, "+");
-            
-            sensorData[1] = (atof(strtok(NULL, "+")));
-            sensorData[0] = (atof(strtok(NULL, "+")));
-            sensorData[2] = (atof(strtok(NULL, "+")));
-        }
-
-        // Teros
-        else if(strstr(getSensorInfo(addr), "TER") != NULL){
-            // Read out the results and parse out each of the data readings and pares them to floats
-            p = strtok(response, "+");
-            
-            sensorData[1] = (atof(strtok(NULL, "+")));
-            sensorData[0] = (atof(strtok(NULL, "+")));
-
-            // If we are on the Teros 12
-            if(strstr(getSensorInfo(addr), "12") != NULL)
-                sensorData[2] = (atof(strtok(NULL, "+")));
+    SensorMeasurement& measurement = *findMeasurement(addr);
+    measurement.concurrent = false;
+    measurement.collected = false;
+    measurement.attempts = 0;
+
+    // Request a measurement and wait however long the sensor says it needs, or until it says the data is ready
+    requestMeasurement(measurement);
+    while(!measurement.collected){
+        while((long)(millis() - measurement.readyTime) < 0 && !serviceRequested(addr)){
+            TIMER_RESET;
+            Loom_Executor::getInstance()->wait(10);
         }
-    }
-    else{
-        ERROR(F("Failed to record new data! Using previous valid information!"));
+        collectData(measurement);
+        TIMER_RESET;
     }
 }
-//////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////////////////////////////////
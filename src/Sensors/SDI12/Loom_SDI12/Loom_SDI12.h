@@ -1,16 +1,26 @@
 #pragma once
 #include <map>
 #include <vector>
+#include <algorithm>
 
 #include "Arduino.h"
 
 #include "Module.h"
 #include "Loom_Manager.h"
+#include "Hardware/Loom_Hypnos/Loom_Hypnos.h"
 
 
 #include <SDI12.h>
+#include "SDI12SensorTypes.h"
 
-#define RESPONSE_SIZE 50
+#define RESPONSE_SIZE 82            // Longest response is a 75 character D! reply after a C! plus the address, CRC and line ending
+#define SENSOR_NAME_SIZE 20
+#define VALUE_KEY_SIZE 9            // Bytes a copied "Value_nn" key takes in the document
+#define MEASURE_ATTEMPTS 3          // Number of times to request a measurement from a sensor before giving up
+#define RETRY_DELAY 3000            // Time in milliseconds to wait before requesting a measurement again
+#define CHARACTER_TIMEOUT 50        // Time in milliseconds without a new character before a response is considered finished
+#define SDI12_CACHE_FILE "SDI12.txt"    // File on the SD card the I! response of each discovered sensor is cached in
+#define SCAN_ADDRESSES_PER_CYCLE 4  // Unknown addresses probed each measurement when the incremental scan is enabled
 
 
 /**
@@ -23,8 +33,14 @@ class Loom_SDI12 : public Module{
         
         
         /* These should be called only by Manager.h */
-        void measure() override;                                // Generic Measure Call To Pull Sensor Data
+        void measure() override { runMeasurement(); };          // Generic Measure Call To Pull Sensor Data
+
+        /* Split measurement, each sensor is only read once the time it reports it needs has passed */
+        void startMeasurement() override;                       // Start a concurrent measurement on every sensor at once
+        bool isMeasurementReady() override;                     // Read each sensor once it is ready, sensors without concurrent support are measured one at a time afterwards
+        void collectMeasurement() override {};                  // Data is stored as each sensor is read
         void package() override;                                // Generic Package Call to Store Sensor Data
+        size_t getPackageSize() override;                       // Each sensor gets its own entry with a value for each field of its type
         void power_down() override;
         void power_up() override;
 
@@ -46,9 +62,57 @@ class Loom_SDI12 : public Module{
         void getData(char addr);                                // Get the data from the connected sensor
         std::vector<char> scanAddressSpace();                   // Scans over the SDI-12 address space and returns a list of in-use addresses
 
-        float getTemperature() { return sensorData[0]; };       // Temperature of the soil
-        float getDielectricPerm() { return sensorData[1]; };    // Dielectric Permittivity of the soil
-        float getConductivity() { return sensorData[2]; };      // Conductivity of the soil
+        /**
+         * Start all sensors measuring at once with C! instead of measuring them one after another with M!, a sensor that doesn't answer C! is still measured with M!
+         * @param enable Whether or not to use concurrent measurements
+         */
+        void setConcurrent(bool enable) { useConcurrent = enable; };
+
+        /**
+         * Cache the discovered sensors on the Hypnos' SD card so later boots only check the known addresses instead of scanning all 62
+         * @param hypnos Hypnos with the SD card to use
+         */
+        void setHypnosInstance(Loom_Hypnos& hypnos) { this->hypnosInst = &hypnos; };
+
+        /**
+         * Always scan the whole address space on initialize instead of trusting the cache
+         * @param enable Whether or not to ignore the cache
+         */
+        void setFullScan(bool enable) { fullScan = enable; };
+
+        /**
+         * Probe a few unused addresses each measurement so newly added sensors end up in the cache, they are measured after the next restart
+         * @param enable Whether or not to scan in the background
+         */
+        void setIncrementalScan(bool enable) { incrementalScan = enable; };
+
+        /**
+         * Get a value from the last measurement of a sensor
+         * @param addr Address of the sensor
+         * @param index Position of the value in the sensor's response
+         */
+        float getValue(char addr, uint8_t index);
+
+        /**
+         * Get a value from the last measurement of a sensor by the field name its type gives it
+         * @param addr Address of the sensor
+         * @param field Name of the field, NAN if the sensor doesn't have it
+         */
+        float getValue(char addr, const char* field);
+
+        /* Number of values in the last measurement of the sensor */
+        uint8_t getValueCount(char addr);
+
+        /* Values of the sensor read most recently, kept for the GS3 and TEROS sketches that only use one sensor */
+        float getTemperature() { return getValue(lastAddress, "Temperature"); };   // Temperature of the soil
+        float getDielectricPerm() { return getValue(lastAddress, (uint8_t)0); };   // Dielectric Permittivity (GS3) or Volumetric Water Content (TEROS) of the soil
+        float getConductivity() { return getValue(lastAddress, "Conductivity"); }; // Conductivity of the soil
+
+        /**
+         * Add a type of sensor to the registry, registered types are checked before the built in GS3 and TEROS types
+         * @param type How to recognize the sensor and what its values are called, the strings must stay valid
+         */
+        static void registerSensorType(const SDI12SensorType& type);
 
     private:
         Manager* manInst;                                       // Instance of the Manager
@@ -57,13 +121,48 @@ class Loom_SDI12 : public Module{
 
         int sensorTracker = 0;                                  // If we have multiple SDI-12 sensors on one bus we need to distinguish them in the json so increment a counter per
 
-        float sensorData[3];                                    // Array of floats to store sensor data
+        char lastAddress = '0';                                 // Address of the sensor read most recently
         std::vector<char> inUseAddresses;                       // List of address that have SDI_12 sensors connected
         std::vector<char*> sensorNames;                         // List of strings of sensor names
 
         std::map<char, const char*> addressToType;              // Maps an SDI12 device address to a device type
 
+        /* Split measurement state */
+        struct SensorMeasurement{
+            char addr;                                          // Address of the sensor
+            bool concurrent = true;                             // Whether the sensor is measured with C! this cycle
+            bool supportsConcurrent = true;                     // Cleared once the sensor doesn't answer C! so it isn't asked again every cycle
+            bool started = false;                               // Whether the sensor has been asked to measure this cycle
+            bool collected = false;                             // Whether the data has been read this cycle
+            uint8_t attempts = 0;                               // Number of times the sensor has been asked to measure this cycle
+            unsigned long readyTime = 0;                        // millis() after which the data can be read
+            uint8_t expected = 0;                               // Number of values the sensor said the measurement will return
+            float values[MAX_SDI12_VALUES];                     // Values from the last good measurement
+            uint8_t count = 0;                                  // Number of values stored
+        };
+        std::vector<SensorMeasurement> measurements;            // Measurement state for each in use address
+        bool useConcurrent = true;                              // Start every sensor at once with C!
+
+        /* Address discovery */
+        Loom_Hypnos* hypnosInst = nullptr;                      // Hypnos whose SD card the address cache is kept on
+        bool fullScan = false;                                  // Ignore the cache and scan every address on initialize
+        bool incrementalScan = false;                           // Probe a few unused addresses every measurement
+        char nextScanAddress = '0';                             // Next address the incremental scan will probe
+        std::vector<char> discoveredAddresses;                  // Sensors found by the incremental scan since startup
+
+        bool loadAddressCache();                                // Check the cached sensors are all still there, returns false if a full scan is needed
+        void saveAddressCache();                                // Write the I! response of every in use address to the cache
+        void scanIncrementally();                               // Probe the next few unused addresses for new sensors
+        SDManager* getCacheSD();                                // SD manager to keep the cache on, null if there isn't a usable one
+
+        void requestMeasurement(SensorMeasurement& measurement);    // Send C! or M! and work out when the data will be ready and how many values there will be from the response
+        void collectData(SensorMeasurement& measurement);           // Read D0! to D9! until every value is in, re-requesting the measurement if there were none
+        SensorMeasurement* findMeasurement(char addr);              // Measurement state for the address, null if it isn't in use
+
+        const SDI12SensorType* findSensorType(char addr);           // Registered type matching the model in the sensor's I! response, null if there isn't one
+        uint8_t parseValues(const char* response, float values[MAX_SDI12_VALUES], uint8_t count);  // Append the signed values from a D! response, returns the new count
         void readResponse(char response[RESPONSE_SIZE]);                   // Reads and returns the sensor's response to the command
+        bool serviceRequested(char addr);                       // Read a pending service request, returns whether it came from the address
         bool checkActive(char addr);                            // Checks if the current address is actually being used
         
 };
@@ -0,0 +1,29 @@
+#include "SDI12SensorTypes.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+std::vector<SDI12SensorType>& sdi12SensorTypes(){
+    // Values are listed in the order the sensors return them
+    static std::vector<SDI12SensorType> types = {
+        {"GS3", "GS3", {"Dielectric_Permittivity", "Temperature", "Conductivity"}},
+        {"TER11", "TER", {"Volumetric_Water_Content", "Temperature"}},
+        {"TER12", "TER", {"Volumetric_Water_Content", "Temperature", "Conductivity"}}
+    };
+    return types;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+const SDI12SensorType* matchSDI12SensorType(const char* info){
+    // Only the model is compared, the vendor field (eg. METER) would otherwise match types like TER
+    if(info == nullptr || strlen(info) <= SDI12_MODEL_OFFSET)
+        return nullptr;
+
+    const char* model = info + SDI12_MODEL_OFFSET;
+    for(int i = 0; i < sdi12SensorTypes().size(); i++){
+        const char* match = sdi12SensorTypes()[i].match;
+        if(strlen(match) <= SDI12_MODEL_SIZE && strncmp(model, match, strlen(match)) == 0)
+            return &sdi12SensorTypes()[i];
+    }
+    return nullptr;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////
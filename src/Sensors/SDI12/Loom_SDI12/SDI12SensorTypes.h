@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Arduino.h"
+#include <vector>
+
+#define MAX_SDI12_VALUES 20         // Most values stored per sensor
+
+/* I! response layout: address, 2 character SDI-12 version, 8 character vendor, 6 character model, 3 character sensor version, then an optional serial number */
+#define SDI12_MODEL_OFFSET 11       // Index of the model field in the I! response
+#define SDI12_MODEL_SIZE 6          // Length of the model field, shorter models are padded with spaces
+
+/**
+ * Describes how to name the values a type of sensor returns
+ * Types are matched against the model field of the sensor's I! response, anything not in the registry is packaged as Value_1, Value_2...
+ * Only the named values of a registered type are packaged, any extra values can still be read with getValue()
+ */
+struct SDI12SensorType{
+    const char* match;                          // Start of the model field that identifies the sensor (eg. TER12), the vendor is not checked
+    const char* name;                           // Name the sensor is packaged under, followed by its index
+    const char* fields[MAX_SDI12_VALUES];       // Name of each value in the order the D commands return them
+};
+
+/**
+ * Registry of sensor types, starts with the built in GS3 and TEROS types
+ */
+std::vector<SDI12SensorType>& sdi12SensorTypes();
+
+/**
+ * Find the registered type for a sensor
+ * @param info The sensor's I! response, starting with its address
+ * @return The first type whose match starts the model field, null if there isn't one
+ */
+const SDI12SensorType* matchSDI12SensorType(const char* info);
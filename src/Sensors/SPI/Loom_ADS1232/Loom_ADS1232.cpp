@@ -5,7 +5,8 @@ Loom_ADS1232::Loom_ADS1232(Manager& man, int num_samples, long offset, float sca
     // Set offset, scale, and number of samples
     this->offset = offset;
     this->scale = scale;
-    this->num_samples = num_samples;
+    addSampleField("weight", &weight);
+    setSampling(num_samples);
     // Set pins
     inst.PDWN = A2;
     inst.SCLK = A1;
@@ -37,7 +38,9 @@ void Loom_ADS1232::power_down(){
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_ADS1232::measure(){
     if (!inst.is_ready()) inst.power_up();
-    weight = inst.units_read(num_samples);
+
+    // Samples are taken and averaged by the manager, see Module::setSampling()
+    weight = inst.units_read(1);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
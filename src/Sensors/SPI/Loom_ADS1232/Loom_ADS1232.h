@@ -16,6 +16,13 @@ class Loom_ADS1232 : public Module{
          
 
     public:
+        /**
+         * Construct a new weight sensor
+         * @param man Reference to the manager
+         * @param num_samples The number of samples to collect and average, see Module::setSampling() to space them out or package their statistics
+         * @param offset Calibration offset
+         * @param scale Calibration scale
+         */
         Loom_ADS1232(Manager& man, int num_samples = 1, long offset = 8403613, float scale = 2041.46);
 
         void initialize() override;
@@ -40,10 +47,9 @@ class Loom_ADS1232 : public Module{
 
         ADS1232_Lib inst;       // Instance of the library
 
-        float weight;           // Weight output
+        float weight = 0;       // Weight output
 
         long offset;            // Calibration offset
         float scale;            // Calibration scale
-        int num_samples;        // Number of samples to collect
 
 };
\ No newline at end of file
@@ -26,7 +26,7 @@ class Loom_MAX31856 : public Module{
          * Construct a new sensor class
          * @param man Reference to the manager
          * @param chip_select What pin SPI pin to use
-         * @param num_samples The number of samples to collect and average
+         * @param samples The number of samples to collect and average, see Module::setSampling() to space them out or package their statistics
          * @param mosi
          * @param miso
          * @param sclk
@@ -42,7 +42,6 @@ class Loom_MAX31856 : public Module{
         Manager* manInst;           // Instance of the manager
 
         Adafruit_MAX31856 maxthermo;      // Instance of the MAX31856 library
-        int num_samples;            // Number of samples to take and average
 
         float temperature = 0;      // Temperature that will be packaged
 };
\ No newline at end of file
@@ -2,7 +2,9 @@
 #include "Logger.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
-Loom_MAX31865::Loom_MAX31865(Manager& man, int samples, int chip_select) : Module("MAX31865"), manInst(&man), max(chip_select), num_samples(samples) {
+Loom_MAX31865::Loom_MAX31865(Manager& man, int chip_select, int samples) : Module("MAX31865"), manInst(&man), max(chip_select) {
+    addSampleField("Temperature_°C", &temperature);
+    setSampling(samples);
     manInst->registerModule(this);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -15,27 +17,21 @@ void Loom_MAX31865::initialize(){
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 void Loom_MAX31865::measure(){
-    float temp = 0;
+    // Samples are taken and averaged by the manager, see Module::setSampling()
+    temperature = max.temperature(RNOMINAL, RREF);
 
-    // Collect the data however many times as specified
-    for(int i = 0; i < num_samples; i++){
-        temp += max.temperature(RNOMINAL, RREF);
-
-        // Check and print any faults
-        uint8_t fault = max.readFault();
-        if (fault) {
-            if (fault & MAX31865_FAULT_HIGHTHRESH)  ERROR(F("RTD High Threshold")); 
-            if (fault & MAX31865_FAULT_LOWTHRESH)   ERROR(F("RTD Low Threshold")); 
-            if (fault & MAX31865_FAULT_REFINLOW)    ERROR(F("REFIN- > 0.85 x Bias")); 
-            if (fault & MAX31865_FAULT_REFINHIGH)   ERROR(F("REFIN- < 0.85 x Bias - FORCE- open")); 
-            if (fault & MAX31865_FAULT_RTDINLOW)    ERROR(F("RTDIN- < 0.85 x Bias - FORCE- open")); 
-            if (fault & MAX31865_FAULT_OVUV)        ERROR(F("Under/Over voltage")); 
-            break;
-        }
+    // Check and print any faults, a faulted reading is reported as NaN so it isn't averaged in
+    uint8_t fault = max.readFault();
+    if (fault) {
+        if (fault & MAX31865_FAULT_HIGHTHRESH)  ERROR(F("RTD High Threshold")); 
+        if (fault & MAX31865_FAULT_LOWTHRESH)   ERROR(F("RTD Low Threshold")); 
+        if (fault & MAX31865_FAULT_REFINLOW)    ERROR(F("REFIN- > 0.85 x Bias")); 
+        if (fault & MAX31865_FAULT_REFINHIGH)   ERROR(F("REFIN- < 0.85 x Bias - FORCE- open")); 
+        if (fault & MAX31865_FAULT_RTDINLOW)    ERROR(F("RTDIN- < 0.85 x Bias - FORCE- open")); 
+        if (fault & MAX31865_FAULT_OVUV)        ERROR(F("Under/Over voltage")); 
+        max.clearFault();
+        temperature = NAN;
     }
-    
-    // Get the average temperature
-    temperature = temp / num_samples;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -29,7 +29,7 @@ class Loom_MAX31865 : public Module{
          * Construct a new sensor class
          * @param man Reference to the manager
          * @param chip_select What pin SPI pin to use
-         * @param num_samples The number of samples to collect and average
+         * @param samples The number of samples to collect and average, see Module::setSampling() to space them out or package their statistics
          */ 
         Loom_MAX31865(Manager& man, int chip_select = 10, int samples = 1);
 
@@ -42,7 +42,6 @@ class Loom_MAX31865 : public Module{
         Manager* manInst;           // Instance of the manager
 
         Adafruit_MAX31865 max;      // Instance of the MAX31865 library
-        int num_samples;            // Number of samples to take and average
 
         float temperature = 0;      // Temperature that will be packaged
 };
\ No newline at end of file
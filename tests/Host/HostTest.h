@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdio.h>
+#include <math.h>
+
+// Minimal checks for the host tests, each failure is printed and counted and main() returns the count
+
+static int hostTestFailures = 0;
+
+#define CHECK(condition) do {                                                                       \
+    if(!(condition)){                                                                               \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);                        \
+        hostTestFailures++;                                                                         \
+    }                                                                                               \
+} while (false)
+
+#define CHECK_CLOSE(actual, expected, tolerance) do {                                               \
+    double a_ = (actual), e_ = (expected), t_ = (tolerance);                                        \
+    if(!(fabs(a_ - e_) <= t_)){                                                                     \
+        printf("%s:%d: %s = %.9g, expected %.9g +/- %.3g\n", __FILE__, __LINE__, #actual, a_, e_, t_); \
+        hostTestFailures++;                                                                         \
+    }                                                                                               \
+} while (false)
+
+#define TEST_RESULT() (printf("%s: %s\n", __FILE__, hostTestFailures == 0 ? "passed" : "FAILED"), hostTestFailures)
@@ -0,0 +1,152 @@
+/**
+ * Drives the I2C bus queue and the EZO read path through the scripted mock backend
+ */
+#include "Loom_I2CMock.h"
+#include "Sensors/I2C/EZO/EZOSensor.h"
+#include "HostTest.h"
+
+#define EZO_ADDRESS 0x63
+
+/**
+ * EZO device that keeps whatever reading it was handed
+ */
+class TestEZO : public EZOSensor{
+    public:
+        TestEZO() : EZOSensor("TestEZO", 0) { module_address = EZO_ADDRESS; };
+
+        void initialize() override {};
+        void package() override {};
+        void power_up() override {};
+        void power_down() override {};
+
+        char reading[EZO_RESPONSE_SIZE] = {0};
+        int readings = 0;
+
+    protected:
+        void parseReading(const char* data) override { strncpy(reading, data, EZO_RESPONSE_SIZE - 1); readings++; };
+};
+
+// Counts completions and remembers the last status
+static int completions = 0;
+static I2C_STATUS lastStatus = I2C_STATUS::QUEUED;
+static void countCompletion(I2CTransaction& transaction, void* context){
+    completions++;
+    lastStatus = transaction.status;
+    CHECK(context == &completions);
+}
+
+static void testBus(Loom_I2CMock& mock){
+    Loom_I2CBus* bus = Loom_I2CBus::getInstance();
+    uint8_t response[3] = {0x12, 0x34, 0x56};
+    uint8_t buffer[8];
+
+    // Missing devices NACK, present ones answer
+    mock.setResponse(0x40, response, 3);
+    CHECK(bus->probe(0x40));
+    CHECK(!bus->probe(0x41));
+
+    // Register write then read in one transaction, short responses are padded like a floating bus
+    uint8_t reg = 0x0D;
+    CHECK(bus->transfer(0x40, &reg, 1, buffer, 4));
+    CHECK(buffer[0] == 0x12 && buffer[2] == 0x56 && buffer[3] == 0xFF);
+
+    uint8_t written[4];
+    CHECK(mock.getLastWrite(0x40, written, 4) == 1 && written[0] == 0x0D);
+
+    // Transactions queue up behind the one on the bus and finish in order
+    mock.setLatency(2000);
+    I2CTransaction first, second;
+    first.address = second.address = 0x40;
+    first.readData = buffer;
+    second.readData = buffer + 4;
+    first.readLength = second.readLength = 2;
+    bus->submit(first);
+    bus->submit(second);
+    CHECK(first.status == I2C_STATUS::ACTIVE);
+    CHECK(second.status == I2C_STATUS::QUEUED);
+    CHECK(bus->wait(second));
+    CHECK(first.status == I2C_STATUS::DONE);
+
+    // Submitting doesn't block, the callback fires once the executor has moved the queue along
+    I2CTransaction callback = first;
+    callback.onComplete = countCompletion;
+    callback.context = &completions;
+    bus->submit(callback);
+    CHECK(completions == 0);
+    delay(3);
+    Loom_Executor::getInstance()->runPending();
+    CHECK(completions == 1 && lastStatus == I2C_STATUS::DONE);
+
+    // Cancelled transactions leave the queue without their callback
+    bus->submit(callback);
+    CHECK(bus->cancel(callback));
+    CHECK(!bus->cancel(callback));
+    CHECK(completions == 1);
+
+    // A device that holds the bus too long times out
+    mock.setLatency((I2C_TRANSACTION_TIMEOUT + 50) * 1000UL);
+    I2CTransaction slow = first;
+    bus->submit(slow);
+    CHECK(!bus->wait(slow));
+    CHECK(slow.status == I2C_STATUS::TIMEOUT);
+    mock.setLatency(0);
+
+    // Every transaction to the device is counted, NACKs as failures
+    const I2CDeviceStats* stats = bus->getStats(0x41);
+    CHECK(stats != nullptr && stats->transactions == 1 && stats->failures == 1);
+}
+
+static void testEZO(Loom_I2CMock& mock){
+    TestEZO ezo;
+
+    // Success code followed by the null terminated reading
+    const uint8_t success[] = {1, '7', '.', '0', '2', '\0'};
+    mock.setResponse(EZO_ADDRESS, success, sizeof(success));
+    ezo.startMeasurement();
+
+    uint8_t command[2];
+    CHECK(mock.getLastWrite(EZO_ADDRESS, command, 2) == 1 && command[0] == 'r');
+    CHECK(ezo.isMeasurementReady());
+
+    ezo.collectMeasurement();
+    CHECK(ezo.readings == 1);
+    CHECK(strcmp(ezo.reading, "7.02") == 0);
+    CHECK(strcmp(ezo.getSensorData(), "7.02") == 0);
+
+    // The response is queued once the device has had its read time and collected when the bus gets to it
+    mock.setLatency(2000);
+    ezo.startMeasurement();
+    CHECK(!ezo.isMeasurementReady());
+    delay(3);
+    Loom_Executor::getInstance()->runPending();
+    CHECK(ezo.isMeasurementReady());
+    ezo.collectMeasurement();
+    CHECK(ezo.readings == 2);
+    mock.setLatency(0);
+
+    // Still processing, the reading isn't handed on
+    const uint8_t pending[] = {254};
+    mock.setResponse(EZO_ADDRESS, pending, sizeof(pending));
+    ezo.startMeasurement();
+    ezo.collectMeasurement();
+    CHECK(ezo.readings == 2);
+
+    // A device that has gone away fails the read without parsing anything
+    mock.setPresent(EZO_ADDRESS, false);
+    ezo.startMeasurement();
+    ezo.collectMeasurement();
+    CHECK(ezo.readings == 2);
+    CHECK(!ezo.checkDeviceConnection());
+    CHECK(ezo.needsReinit);
+}
+
+int main(){
+    Loom_I2CMock mock;
+    Loom_I2CBus::getInstance()->setBackend(&mock);
+
+    testBus(mock);
+    testEZO(mock);
+
+    Loom_I2CBus::getInstance()->printStats();
+    return TEST_RESULT();
+}
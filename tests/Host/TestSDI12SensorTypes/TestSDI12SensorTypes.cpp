@@ -0,0 +1,35 @@
+/**
+ * Checks that SDI-12 sensors are recognized by the model field of their I! response and not by text elsewhere in it
+ */
+#include "SDI12SensorTypes.h"
+#include "HostTest.h"
+
+int main(){
+    // address, SDI-12 version, 8 character vendor, 6 character model, sensor version, serial
+    const SDI12SensorType* type = matchSDI12SensorType("013METER   TER12 112631800001");
+    CHECK(type != nullptr && strcmp(type->match, "TER12") == 0);
+    CHECK(type != nullptr && strcmp(type->fields[2], "Conductivity") == 0);
+
+    type = matchSDI12SensorType("213METER   TER11 110");
+    CHECK(type != nullptr && strcmp(type->match, "TER11") == 0);
+    CHECK(type != nullptr && type->fields[2] == nullptr);
+
+    type = matchSDI12SensorType("113Decagon GS3   402");
+    CHECK(type != nullptr && strcmp(type->match, "GS3") == 0);
+
+    // The vendor contains TER but an ATM41 isn't a TEROS probe
+    CHECK(matchSDI12SensorType("313METER   ATM41 140ATM41-00012345") == nullptr);
+
+    // Responses too short to hold a model
+    CHECK(matchSDI12SensorType("013METER") == nullptr);
+    CHECK(matchSDI12SensorType("") == nullptr);
+    CHECK(matchSDI12SensorType(nullptr) == nullptr);
+
+    // Registered types are checked before the built in ones
+    sdi12SensorTypes().insert(sdi12SensorTypes().begin(), SDI12SensorType{"ATM41", "ATM41", {"Solar", "Precipitation"}});
+    type = matchSDI12SensorType("313METER   ATM41 140ATM41-00012345");
+    CHECK(type != nullptr && strcmp(type->name, "ATM41") == 0);
+    CHECK(matchSDI12SensorType("013METER   TER12 112631800001") == &sdi12SensorTypes()[3]);
+
+    return TEST_RESULT();
+}
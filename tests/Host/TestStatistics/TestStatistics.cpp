@@ -0,0 +1,56 @@
+/**
+ * Checks the running statistics behind multi-sample measurements against values worked out by hand
+ */
+#include "Loom_Statistics.h"
+#include "HostTest.h"
+
+int main(){
+    SampleStatistics stats;
+
+    // Nothing added yet
+    CHECK(stats.count == 0);
+    CHECK(stats.variance() == 0);
+
+    // One sample has no spread
+    stats.add(3.5);
+    CHECK(stats.count == 1);
+    CHECK_CLOSE(stats.mean, 3.5, 1e-6);
+    CHECK(stats.minimum == 3.5f && stats.maximum == 3.5f);
+    CHECK(stats.stddev() == 0);
+
+    // 2, 4, 4, 4, 5, 5, 7, 9 has a mean of 5 and a sum of squared differences of 32
+    const float values[] = {2, 4, 4, 4, 5, 5, 7, 9};
+    stats.reset();
+    for(int i = 0; i < 8; i++)
+        stats.add(values[i]);
+    CHECK(stats.count == 8);
+    CHECK_CLOSE(stats.mean, 5, 1e-6);
+    CHECK(stats.minimum == 2 && stats.maximum == 9);
+    CHECK_CLOSE(stats.variance(), 32.0 / 7, 1e-5);
+    CHECK_CLOSE(stats.stddev(), sqrt(32.0 / 7), 1e-5);
+
+    // Failed readings don't count towards anything
+    stats.add(NAN);
+    CHECK(stats.count == 8);
+    CHECK_CLOSE(stats.mean, 5, 1e-6);
+    CHECK(!isnan(stats.stddev()));
+
+    // Negative values set the minimum
+    stats.reset();
+    stats.add(-1.5);
+    stats.add(NAN);
+    stats.add(2.5);
+    CHECK(stats.count == 2);
+    CHECK(stats.minimum == -1.5f && stats.maximum == 2.5f);
+    CHECK_CLOSE(stats.mean, 0.5, 1e-6);
+    CHECK_CLOSE(stats.variance(), 8, 1e-5);
+
+    // The same spread on a large offset, summing squares in a float would lose it
+    stats.reset();
+    for(int i = 0; i < 8; i++)
+        stats.add(1000 + values[i]);
+    CHECK_CLOSE(stats.mean, 1005, 1e-3);
+    CHECK_CLOSE(stats.stddev(), sqrt(32.0 / 7), 1e-3);
+
+    return TEST_RESULT();
+}
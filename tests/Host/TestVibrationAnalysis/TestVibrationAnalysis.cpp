@@ -0,0 +1,52 @@
+/**
+ * Checks the fixed point vibration features against the NumPy reference in VibrationReference.h
+ * The reference is computed in double precision so the tolerances cover the Q15 FFT's rounding
+ */
+#include "VibrationAnalysis.h"
+#include "HostTest.h"
+#include "VibrationReference.h"
+
+#define SUMMARY_TOLERANCE 0.005         // Relative tolerance on the RMS, peak and crest factor, the device removes an integer mean
+#define BAND_TOLERANCE 0.01             // Relative tolerance on each band's energy
+#define BAND_FLOOR 0.001                // Bands are also allowed this fraction of the total energy, for the bands that should be empty
+
+int main(){
+    for(const VibrationReference& reference : REFERENCE_VECTORS){
+        printf("%s\n", reference.name);
+
+        int16_t samples[BURST_SAMPLES];
+        memcpy(samples, reference.samples, sizeof(samples));
+
+        VibrationFeatures features;
+        computeVibrationFeatures(samples, reference.count, REFERENCE_COUNTS_PER_G, REFERENCE_SAMPLE_RATE, features);
+
+        CHECK(features.samples == reference.count);
+        CHECK_CLOSE(features.sampleRate, REFERENCE_SAMPLE_RATE, 0);
+        CHECK_CLOSE(features.rms, reference.rms, reference.rms * SUMMARY_TOLERANCE);
+        CHECK_CLOSE(features.peak, reference.peak, reference.peak * SUMMARY_TOLERANCE);
+        CHECK_CLOSE(features.crestFactor, reference.crestFactor, reference.crestFactor * SUMMARY_TOLERANCE);
+
+        float total = reference.rms * reference.rms;
+        float bandTotal = 0;
+        for(int i = 0; i < FFT_BANDS; i++){
+            CHECK_CLOSE(features.bandEnergy[i], reference.bandEnergy[i], reference.bandEnergy[i] * BAND_TOLERANCE + total * BAND_FLOOR);
+            bandTotal += features.bandEnergy[i];
+        }
+
+        // Every bin but DC is in a band so the bands add up to the RMS squared
+        CHECK_CLOSE(bandTotal, total, total * BAND_TOLERANCE);
+    }
+
+    // An empty burst reports nothing instead of dividing by zero
+    int16_t empty[BURST_SAMPLES] = {0};
+    VibrationFeatures features;
+    computeVibrationFeatures(empty, 0, REFERENCE_COUNTS_PER_G, REFERENCE_SAMPLE_RATE, features);
+    CHECK(features.samples == 0);
+    CHECK_CLOSE(features.rms, 0, 0);
+
+    // The magnitude is halved so a full scale reading on every axis still fits
+    CHECK(selectVibrationAxis(3000, 4000, 0, VIBRATION_AXIS::MAGNITUDE) == 2500);
+    CHECK(selectVibrationAxis(1, 2, 3, VIBRATION_AXIS::Y) == 2);
+
+    return TEST_RESULT();
+}
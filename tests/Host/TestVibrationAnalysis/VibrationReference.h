@@ -0,0 +1,27 @@
+#pragma once
+
+// Generated by generate_reference.py with NumPy 2.4.6, do not edit
+
+#define REFERENCE_COUNTS_PER_G 4096.0f
+#define REFERENCE_SAMPLE_RATE 800.0f
+
+struct VibrationReference{
+    const char* name;
+    int16_t samples[128];
+    uint16_t count;
+    float rms;
+    float peak;
+    float crestFactor;
+    float bandEnergy[4];
+};
+
+static const VibrationReference REFERENCE_VECTORS[] = {
+    {"Sine", {4096, 4479, 4803, 5020, 5096, 5020, 4803, 4479, 4096, 3713, 3389, 3172, 3096, 3172, 3389, 3713, 4096, 4479, 4803, 5020, 5096, 5020, 4803, 4479, 4096, 3713, 3389, 3172, 3096, 3172, 3389, 3713, 4096, 4479, 4803, 5020, 5096, 5020, 4803, 4479, 4096, 3713, 3389, 3172, 3096, 3172, 3389, 3713, 4096, 4479, 4803, 5020, 5096, 5020, 4803, 4479, 4096, 3713, 3389, 3172, 3096, 3172, 3389, 3713, 4096, 4479, 4803, 5020, 5096, 5020, 4803, 4479, 4096, 3713, 3389, 3172, 3096, 3172, 3389, 3713, 4096, 4479, 4803, 5020, 5096, 5020, 4803, 4479, 4096, 3713, 3389, 3172, 3096, 3172, 3389, 3713, 4096, 4479, 4803, 5020, 5096, 5020, 4803, 4479, 4096, 3713, 3389, 3172, 3096, 3172, 3389, 3713, 4096, 4479, 4803, 5020, 5096, 5020, 4803, 4479, 4096, 3713, 3389, 3172, 3096, 3172, 3389, 3713}, 128,
+     1.726470427e-01, 2.441406250e-01, 1.414102560e+00, {2.980699966e-02, 2.175153753e-10, 7.719070512e-10, 7.065547890e-10}},
+    {"TwoTones", {-1748, -1781, -1435, -1790, -2749, -2349, -2444, -1744, -1236, -2013, -2028, -2724, -2587, -1666, -1788, -1359, -2048, -2737, -2308, -2430, -1509, -1372, -2068, -2083, -2860, -2352, -1652, -1747, -1347, -2306, -2661, -2315, -2348, -1317, -1552, -2072, -2195, -2924, -2111, -1685, -1660, -1416, -2527, -2549, -2357, -2196, -1199, -1739, -2048, -2357, -2897, -1900, -1739, -1547, -1569, -2680, -2436, -2411, -1985, -1172, -1901, -2024, -2544, -2779, -1748, -1781, -1435, -1790, -2749, -2349, -2444, -1744, -1236, -2013, -2028, -2724, -2587, -1666, -1788, -1359, -2048, -2737, -2308, -2430, -1509, -1372, -2068, -2083, -2860, -2352, -1652, -1747, -1347, -2306, -2661, -2315, -2348, -1317, -1552, -2072, -2195, -2924, -2111, -1685, -1660, -1416, -2527, -2549, -2357, -2196, -1199, -1739, -2048, -2357, -2897, -1900, -1739, -1547, -1569, -2680, -2436, -2411, -1985, -1172, -1901, -2024, -2544, -2779}, 128,
+     1.158166817e-01, 2.138671875e-01, 1.846600890e+00, {1.018966341e-09, 1.073003582e-02, 1.744690578e-09, 2.683465183e-03}},
+    {"Noise", {-611, 557, 1031, 619, 1117, 2551, -523, 1174, -654, 753, 153, 1439, -90, 876, -374, -999, 816, 1725, 876, -190, 700, 1049, 1346, -298, 999, 758, 489, 521, 37, 78, 1444, 693, 175, -1232, -102, 158, -386, -419, 1090, 339, -678, -423, 302, 1292, -542, 1625, 171, -686, 871, 1518, 357, 966, 289, 504, 1678, 1139, -330, 2472, -203, 1106, 861, 453, 654, 397, 1098, 13, -310, 845, 1728, 416, 1704, 450, 1602, 1186, 878, 1168, -74, 581, -587, -734, 1155, 408, 1216, 604, -29, 2538, 1476, 632, 528, 1669, 287, 1579, 970, -413, 1032, 1294, 895, 1187, 1474, 168, 2090, 625, 1096, -594, 1219, 1017, 103, 990, 866, 1213, 1013, 124, 550, -677, 527, 151, 1260, 1452, 961, -784, 877, -261, 819, 623, -251, -412, 1099, 1996}, 128,
+     1.894269818e-01, 4.744033813e-01, 2.504412924e+00, {7.794235443e-03, 8.599588225e-03, 1.002333993e-02, 9.465417838e-03}},
+    {"ShortBurst", {4096, 4978, 5523, 5523, 4978, 4096, 3214, 2669, 2669, 3214, 4096, 4978, 5523, 5523, 4978, 4096, 3214, 2669, 2669, 3214, 4096, 4978, 5523, 5523, 4978, 4096, 3214, 2669, 2669, 3214, 4096, 4978, 5523, 5523, 4978, 4096, 3214, 2669, 2669, 3214, 4096, 4978, 5523, 5523, 4978, 4096, 3214, 2669, 2669, 3214, 4096, 4978, 5523, 5523, 4978, 4096, 3214, 2669, 2669, 3214, 4096, 4978, 5523, 5523, 4978, 4096, 3214, 2669, 2669, 3214, 4096, 4978, 5523, 5523, 4978, 4096, 3214, 2669, 2669, 3214, 4096, 4978, 5523, 5523, 4978, 4096, 3214, 2669, 2669, 3214, 4096, 4978, 5523, 5523, 4978, 4096, 3214, 2669, 2669, 3214, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 100,
+     2.590309251e-01, 3.483886719e-01, 1.344969415e+00, {6.645833949e-02, 5.732455996e-04, 4.695393968e-05, 1.848111609e-05}},
+};
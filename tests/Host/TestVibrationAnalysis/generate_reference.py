@@ -0,0 +1,80 @@
+"""
+Generates VibrationReference.h, the input bursts and NumPy computed features TestVibrationAnalysis checks computeVibrationFeatures() against
+
+Run from this directory with: python3 generate_reference.py > VibrationReference.h
+"""
+import numpy as np
+
+BURST_SAMPLES = 128
+FFT_BANDS = 4
+COUNTS_PER_G = 4096.0          # MMA8451 at +/-2g
+SAMPLE_RATE = 800.0
+
+def features(samples, count):
+    """Vibration features by definition, with floating point math and NumPy's FFT"""
+    x = np.asarray(samples[:count], dtype=np.float64)
+    x = x - x.mean()
+
+    rms = np.sqrt(np.mean(x ** 2))
+    peak = np.max(np.abs(x))
+
+    # Zero pad to the FFT length, each bin between DC and Nyquist holds half of its power, the Nyquist bin has no mirror and goes in the top band
+    padded = np.zeros(BURST_SAMPLES)
+    padded[:count] = x
+    spectrum = np.fft.fft(padded) / BURST_SAMPLES
+    bins = BURST_SAMPLES // 2 - 1
+    bands = np.zeros(FFT_BANDS)
+    for k in range(1, bins + 1):
+        bands[(k - 1) * FFT_BANDS // bins] += 2 * abs(spectrum[k]) ** 2
+    bands[FFT_BANDS - 1] += abs(spectrum[BURST_SAMPLES // 2]) ** 2
+
+    # Undo the energy the zero padding spread out
+    bands *= BURST_SAMPLES / count
+    return rms / COUNTS_PER_G, peak / COUNTS_PER_G, peak / rms, bands / COUNTS_PER_G ** 2
+
+def vectors():
+    n = np.arange(BURST_SAMPLES)
+    rng = np.random.default_rng(1234)
+
+    # Gravity on the axis plus a tone that falls in the middle of the first band
+    yield "Sine", 4096 + 1000 * np.sin(2 * np.pi * 8 * n / BURST_SAMPLES), BURST_SAMPLES
+
+    # Two tones in the second and fourth bands
+    yield "TwoTones", -2048 + 600 * np.sin(2 * np.pi * 20 * n / BURST_SAMPLES) + 300 * np.cos(2 * np.pi * 50 * n / BURST_SAMPLES), BURST_SAMPLES
+
+    # Broadband noise spreads over every band
+    yield "Noise", 512 + rng.normal(0, 700, BURST_SAMPLES), BURST_SAMPLES
+
+    # A burst cut short by a FIFO overrun, the end is zero padded
+    yield "ShortBurst", 4096 + 1500 * np.sin(2 * np.pi * 0.1 * n), 100
+
+def main():
+    print("#pragma once")
+    print()
+    print("// Generated by generate_reference.py with NumPy %s, do not edit" % np.__version__)
+    print()
+    print("#define REFERENCE_COUNTS_PER_G %.1ff" % COUNTS_PER_G)
+    print("#define REFERENCE_SAMPLE_RATE %.1ff" % SAMPLE_RATE)
+    print()
+    print("struct VibrationReference{")
+    print("    const char* name;")
+    print("    int16_t samples[%d];" % BURST_SAMPLES)
+    print("    uint16_t count;")
+    print("    float rms;")
+    print("    float peak;")
+    print("    float crestFactor;")
+    print("    float bandEnergy[%d];" % FFT_BANDS)
+    print("};")
+    print()
+    print("static const VibrationReference REFERENCE_VECTORS[] = {")
+    for name, signal, count in vectors():
+        samples = np.round(signal).astype(np.int16)
+        samples[count:] = 0
+        rms, peak, crest, bands = features(samples, count)
+        values = ", ".join(str(v) for v in samples)
+        print("    {\"%s\", {%s}, %d," % (name, values, count))
+        print("     %.9e, %.9e, %.9e, {%s}}," % (rms, peak, crest, ", ".join("%.9e" % b for b in bands)))
+    print("};")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,3 @@
+#pragma once
+
+// The watchdog is never enabled in the host tests
@@ -0,0 +1,34 @@
+#pragma once
+
+// Just enough of the Arduino core to compile the hardware independent parts of Loom on a PC
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+
+#ifndef PI
+    #define PI 3.1415926535897932384626433832795
+#endif
+
+#define F(str) str
+#define PSTR(str) str
+#define snprintf_P snprintf
+
+inline unsigned long micros() { return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long ms) { unsigned long start = millis(); while(millis() - start < ms); }
+inline void yield() {}
+
+struct HostSerial{
+    void println(const char* str) { printf("%s\n", str); }
+};
+inline HostSerial Serial;
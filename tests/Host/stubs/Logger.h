@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdio.h>
+
+// Replaces the Loom logger, which needs the Hypnos and its SD card, with plain printf
+// The Makefile copies this over src/Logger.h in the staged sources so headers in src find it too
+
+#define FUNCTION_START
+#define FUNCTION_END
+
+#define LOG(msg)            printf("[DEBUG] %s\n", (const char*)(msg))
+#define SLOG(msg)           LOG(msg)
+#define WARNING(msg)        printf("[WARNING] %s\n", (const char*)(msg))
+#define ERROR(msg)          printf("[ERROR] %s\n", (const char*)(msg))
+
+#define LOGF(msg, ...)      printf("[DEBUG] " msg "\n",##__VA_ARGS__)
+#define SLOGF(msg, ...)     LOGF(msg,##__VA_ARGS__)
+#define WARNINGF(msg, ...)  printf("[WARNING] " msg "\n",##__VA_ARGS__)
+#define ERRORF(msg, ...)    printf("[ERROR] " msg "\n",##__VA_ARGS__)
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Arduino.h"
+
+// The host tests install the I2C mock as the bus backend so the Wire backend never gets a device to talk to
+
+class TwoWire{
+    public:
+        void begin() {}
+        void beginTransmission(uint8_t) {}
+        size_t write(uint8_t) { return 1; }
+        size_t write(const uint8_t*, size_t length) { return length; }
+        uint8_t endTransmission(bool = true) { return 2; }
+        uint8_t requestFrom(uint8_t, size_t) { return 0; }
+        size_t readBytes(uint8_t*, size_t) { return 0; }
+        int available() { return 0; }
+        int read() { return -1; }
+};
+inline TwoWire Wire;